@@ -38,3 +38,17 @@ create table optresults
     doublev10       decimal,        -- this is a dummy value
     doublev11       decimal         -- the optimality gap of the initial solution computed as (initial_solution_objf_value - opt_objf_value) / opt_objf_value
 );
+
+create table regresults
+(
+    -- rows of the results table of the regression mode (iio -regress), see src/optregress.h
+    ifname          varchar(32),    -- the name of the generated instance
+    algorithm       varchar(16),    -- the configuration file name, without extension
+    optstatus       varchar(16),    -- the algorithm status
+    objvalue        decimal,        -- the objective function value
+    runtime         decimal,        -- the optimization runtime in seconds
+    pivots          integer,        -- the number of basis changes (intv5 of optresults)
+    peakrss         decimal,        -- the peak resident set size of the run in MB, 'nan' if not measured
+    baseruntime     decimal,        -- the runtime of the baseline in seconds, 'nan' if none
+    flag            varchar(16)     -- ok, mismatch, failed or regression
+);
@@ -0,0 +1,361 @@
+///
+/// src/algs/CostScaling.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+
+#include "CostScaling.h"
+#include "util.h"
+#include "MyLog.h"
+
+
+#define GETOPTT(start) ((double)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0)
+#define GETOPTTMS(start) ((double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0)
+
+/// discharges between two time limit checks
+#define CSTLIMCHECK 1024
+
+typedef OptLogger<std::string, std::string, double, std::string> OptReportTab;
+#define INITOPTRTAB(optrtab) \
+    optrtab.push_back(std::make_tuple(40, 0, "SCOPE")); \
+    optrtab.push_back(std::make_tuple(24, 0, "STAT")); \
+    optrtab.push_back(std::make_tuple(24, 1, "VALUE")); \
+    optrtab.push_back(std::make_tuple(8, 0, "UNIT"))
+#define ORTABLINE(lglevl, optrtab, scope_str, time_str, val, unit_str) \
+    FILE_LOG(lglevl) << optrtab.getFormatedLine(std::make_tuple(scope_str, time_str, val, unit_str))
+
+
+CostScaling::CostScaling(const std::shared_ptr<TpInstance::TProblemData>& idatsptr, unsigned long long, unsigned long long a)
+    : tpdata_sptr(idatsptr)
+    , M(idatsptr->m)
+    , N(idatsptr->n)
+    , alpha(a > 1 ? a : 8)
+    , cscale(idatsptr->m + idatsptr->n + 1)
+{
+    /// integer costs only
+    double maxac = 0.0;
+    auto check = [&maxac](const TpCostType* beg, const TpCostType* end)
+    {
+        for(auto it = beg; it != end; it++)
+        {
+            if(*it != std::round(*it))
+                throw std::invalid_argument("Cost scaling requires integer costs, found " + std::to_string(*it));
+            maxac = std::max(maxac, std::abs(*it));
+        }
+    };
+    check(tpdata_sptr->costs.begin(), tpdata_sptr->costs.end());
+    /// slack lanes of an unbalanced problem
+    const std::vector<TpCostType>& scs = tpdata_sptr->costs.slackCosts();
+    check(scs.data(), scs.data() + scs.size());
+    /// lanes without arcs of sparse instances cost big M
+    if(tpdata_sptr->costs.isSparse())
+        maxac = std::max(maxac, tpdata_sptr->costs.bigM());
+    if(maxac * cscale * (M + N) > double(std::numeric_limits<price_type>::max() / 4))
+        throw std::invalid_argument("Cost scaling ::: costs too large for the price range");
+}
+
+CostScaling::~CostScaling()
+{
+}
+
+const std::vector<TpQuantityType>& CostScaling::getFlows()
+{
+    return flows;
+}
+
+optresult CostScaling::solve(double tlim, bool alginfolog, bool reptab)
+{
+    /// local vars
+    price_type eps;
+    price_type max_cost;
+    unsigned long long phases;
+    bool completed;
+    double objf_value;
+    double tot_q;
+
+    if(alginfolog)
+    {
+        FILE_LOG(logINFO) << "Cost-scaling push-relabel algorithm"
+                          << "\n\t\t\teps reduction factor = " << alpha
+                          << "\n\t\t\tcost scale = " << cscale;
+    }
+    FILE_LOG(logINFO)  << "Start transportation cost optimization ...";
+
+    /// step times as in TSimplex::tsimplex(..), 1. data init. time, 2. opt. time, 8. tot. time
+    std::vector<double> cmp_times(10, 0.0);
+    auto st_0 = std::chrono::steady_clock::now();
+
+    /// capacitated problems: the excess of infeasible capacities could never be discharged
+    if(!tpdata_sptr->capacities.empty())
+    {
+        std::unordered_map<NodeArcIdType, TpQuantityType> cflows;
+        std::vector<NodeArcIdType> clanes;
+        if(!tpdata_sptr->capacitatedFlow(std::vector<NodeArcIdType>(), std::vector<NodeArcIdType>(), cflows, clanes))
+            throw std::runtime_error("Capacitated problem ::: no feasible flow within the capacities");
+    }
+
+    /// init. data
+    flows.assign(M * N, 0.0);
+    excess.resize(M + N);
+    for(NodeArcIdType i = 0; i < M; i++)
+        excess[i] = tpdata_sptr->sources[i];
+    for(NodeArcIdType j = 0; j < N; j++)
+        excess[M + j] = -tpdata_sptr->destinations[j];
+    prices.assign(M + N, 0);
+    cur_arc.assign(M + N, 0);
+    dst_rows.assign(N, std::vector<NodeArcIdType>());
+    in_dst_rows.assign(M * N, false);
+    active.clear();
+    is_active.assign(M + N, false);
+    pushes = relabels = 0;
+
+    max_cost = 0;
+    for(NodeArcIdType i = 0; i < M; i++)
+        for(NodeArcIdType j = 0; j < N; j++)
+            max_cost = std::max(max_cost, std::abs(this->scaledCost(i, j)));
+    cmp_times[1] = GETOPTTMS(st_0);
+
+    /// refine phases down to eps = 1
+    auto st_2 = std::chrono::steady_clock::now();
+    eps = std::max(max_cost, price_type(1));
+    phases = 0;
+    do
+    {
+        eps = std::max(eps / price_type(alpha), price_type(1));
+        completed = this->refine(eps, tlim, st_0);
+        ++phases;
+        FILE_LOG(logINFO) << "Refine phase " << phases << " ::: eps >> " << eps
+                          << " ::: pushes >> " << pushes << " ::: relabels >> " << relabels
+                          << " ::: time >> " << std::setprecision(3) << std::fixed << GETOPTTMS(st_2) << " [ms]";
+    }
+    while(completed && eps > 1);
+    cmp_times[2] = GETOPTTMS(st_2);
+
+    /// obj. f.
+    objf_value = tot_q = 0.0;
+    for(NodeArcIdType i = 0; i < M; i++)
+    {
+        for(NodeArcIdType j = 0; j < N; j++)
+        {
+            objf_value += tpdata_sptr->costs[N * i + j] * flows[N * i + j];
+            tot_q += flows[N * i + j];
+        }
+    }
+    cmp_times[8] = GETOPTTMS(st_0);
+    FILE_LOG(logINFO) << (completed ? "Optimal solution found" : "Limit reached");
+
+    /// Fill-in opt. results
+    optresult optres;
+    optres.obj_value = objf_value;
+    optres.run_time = GETOPTT(st_0);
+    optres.tags.resize(3);
+    optres.tags[1] = "CS";
+    optres.tags[2] = completed ? "Optimal" : "NotOptimal";
+    /// sparse instances: an optimal solution shipping on big M lanes costs more than any solution on the arcs
+    if(completed && tpdata_sptr->costs.isSparse() && objf_value > std::max(0.0, tpdata_sptr->maxc) * tot_q + 0.5)
+    {
+        FILE_LOG(logWARNING) << "Sparse instance ::: optimal solution on lanes without arcs ::: infeasible";
+        optres.tags[2] = "Infeasible";
+    }
+    optres.integer_values.resize(2, 0);
+    optres.integer_values.push_back(phases);
+    optres.integer_values.push_back(relabels);
+    optres.integer_values.push_back(pushes);
+    optres.integer_values.resize(10, 0);
+    optres.double_values.assign(cmp_times.begin(), cmp_times.end());
+    optres.double_values.push_back(std::numeric_limits<double>::quiet_NaN());
+
+    /// Log opt. info.
+    FILE_LOG(logINFO) << "----------------------------------------";
+    FILE_LOG(logINFO) << std::setw(16) << "objf" << std::setw(24) << std::setprecision(0) << std::fixed  << optres.obj_value;
+    FILE_LOG(logINFO) << std::setw(16) << "totq" << std::setw(24) << std::setprecision(0) << std::fixed  << tot_q;
+    FILE_LOG(logINFO) << std::setw(16) << "time" << std::setw(24) << std::setprecision(0) << std::fixed  << cmp_times[8] << " [ms]";
+    FILE_LOG(logINFO) << std::setw(16) << "phases" << std::setw(24) << std::setprecision(0) << std::fixed << phases;
+    FILE_LOG(logINFO) << std::setw(16) << "pushes" << std::setw(24) << std::setprecision(0) << std::fixed << pushes;
+    FILE_LOG(logINFO) << std::setw(16) << "relabels" << std::setw(24) << std::setprecision(0) << std::fixed << relabels;
+    FILE_LOG(logINFO) << "----------------------------------------";
+    if(reptab)
+    {
+        FILE_LOG(logINFO) << "Optimization report";
+        
+        std::vector<OptLogMeta> tabstuff;
+        INITOPTRTAB(tabstuff);
+        OptReportTab optreptab(tabstuff);
+        FILE_LOG(logINFO) << optreptab.getFormatedHeader();
+        ORTABLINE(logINFO, optreptab, "global", "objf value", optres.obj_value, "");
+        ORTABLINE(logINFO, optreptab, "global", "transhipped quantity", tot_q, "");
+        ORTABLINE(logINFO, optreptab, "global", "tot time", optres.run_time, "[s]");
+        ORTABLINE(logINFO, optreptab, "global", "tot time", cmp_times[8], " [ms]");
+        ORTABLINE(logINFO, optreptab, "global", "data init time", cmp_times[1], " [ms]");
+        ORTABLINE(logINFO, optreptab, "cost scaling", "refine phases", phases, "");
+        ORTABLINE(logINFO, optreptab, "cost scaling", "pushes", pushes, "");
+        ORTABLINE(logINFO, optreptab, "cost scaling", "relabels", relabels, "");
+        ORTABLINE(logINFO, optreptab, "cost scaling", "opt time", cmp_times[2], " [ms]");
+    }
+    
+    return optres;
+}
+
+bool CostScaling::refine(price_type eps, double tlim, const std::chrono::steady_clock::time_point& start)
+{
+    price_type cp;
+    unsigned long long discharges;
+
+    /// saturate arcs of negative reduced cost, 0-optimal pseudoflow
+    for(NodeArcIdType i = 0; i < M; i++)
+    {
+        for(NodeArcIdType j = 0; j < N; j++)
+        {
+            cp = this->scaledCost(i, j) + prices[i] - prices[M + j];
+            if(cp < 0 && flows[N * i + j] < this->capacity(i, j))
+                this->setFlow(i, j, this->capacity(i, j));
+            else if(cp > 0 && flows[N * i + j] > 0.0)
+                this->setFlow(i, j, 0.0);
+        }
+    }
+
+    /// active nodes
+    active.clear();
+    for(NodeArcIdType v = 0; v < M + N; v++)
+    {
+        cur_arc[v] = 0;
+        if((is_active[v] = excess[v] > MYEPS))
+            active.push_back(v);
+    }
+
+    /// discharge active nodes
+    discharges = 0;
+    while(!active.empty())
+    {
+        NodeArcIdType v = active.front();
+        active.pop_front();
+        is_active[v] = false;
+        this->discharge(v, eps);
+
+        if(++discharges % CSTLIMCHECK == 0 && !std::isnan(tlim) && tlim + MYEPS < GETOPTT(start))
+            return false;
+    }
+
+    return true;
+}
+
+void CostScaling::discharge(NodeArcIdType v, price_type eps)
+{
+    TpQuantityType delta;
+
+    while(excess[v] > MYEPS)
+    {
+        if(v < M)
+        {   /// source: forward arcs with residual capacity
+            NodeArcIdType i = v;
+            NodeArcIdType& j = cur_arc[v];
+            for( ; j < N && excess[v] > MYEPS; j++)
+            {
+                if(this->scaledCost(i, j) + prices[i] - prices[M + j] < 0 && flows[N * i + j] < this->capacity(i, j))
+                {
+                    delta = std::min(excess[v], this->capacity(i, j) - flows[N * i + j]);
+                    this->setFlow(i, j, flows[N * i + j] + delta);
+                    ++pushes;
+                    if(excess[M + j] > MYEPS && !is_active[M + j])
+                    {
+                        is_active[M + j] = true;
+                        active.push_back(M + j);
+                    }
+                    if(!(excess[v] > MYEPS))
+                        break;
+                }
+            }
+            if(excess[v] > MYEPS)
+                this->relabel(v, eps);
+        }
+        else
+        {   /// destination: reverse arcs of the sources sending flow
+            NodeArcIdType j = v - M;
+            NodeArcIdType& k = cur_arc[v];
+            std::vector<NodeArcIdType>& rows = dst_rows[j];
+            while(k < rows.size() && excess[v] > MYEPS)
+            {
+                NodeArcIdType i = rows[k];
+                if(!(flows[N * i + j] > 0.0))
+                {   /// lazy removal
+                    in_dst_rows[N * i + j] = false;
+                    rows[k] = rows.back();
+                    rows.pop_back();
+                    continue;
+                }
+                if(-this->scaledCost(i, j) + prices[v] - prices[i] < 0)
+                {
+                    delta = std::min(excess[v], flows[N * i + j]);
+                    this->setFlow(i, j, flows[N * i + j] - delta);
+                    ++pushes;
+                    if(excess[i] > MYEPS && !is_active[i])
+                    {
+                        is_active[i] = true;
+                        active.push_back(i);
+                    }
+                    if(!(excess[v] > MYEPS))
+                        break;
+                }
+                ++k;
+            }
+            if(excess[v] > MYEPS)
+                this->relabel(v, eps);
+        }
+    }
+}
+
+void CostScaling::relabel(NodeArcIdType v, price_type eps)
+{
+    price_type maxp = std::numeric_limits<price_type>::lowest();
+
+    /// max. price of the residual arc heads, minus reduced cost
+    if(v < M)
+    {
+        for(NodeArcIdType j = 0; j < N; j++)
+            if(flows[N * v + j] < this->capacity(v, j))
+                maxp = std::max(maxp, prices[M + j] - this->scaledCost(v, j));
+    }
+    else
+    {
+        NodeArcIdType j = v - M;
+        for(auto it = dst_rows[j].begin(); it != dst_rows[j].end(); it++)
+            if(flows[N * (*it) + j] > 0.0)
+                maxp = std::max(maxp, prices[*it] + this->scaledCost(*it, j));
+    }
+    if(maxp == std::numeric_limits<price_type>::lowest())
+        throw std::runtime_error("Cost scaling ::: active node " + std::to_string(v) + " without residual arcs");
+
+    prices[v] = maxp - eps;
+    cur_arc[v] = 0;
+    ++relabels;
+}
+
+void CostScaling::setFlow(NodeArcIdType i, NodeArcIdType j, TpQuantityType q)
+{
+    TpQuantityType delta = q - flows[N * i + j];
+
+    flows[N * i + j] = q;
+    excess[i] -= delta;
+    excess[M + j] += delta;
+    if(q > 0.0 && !in_dst_rows[N * i + j])
+    {
+        in_dst_rows[N * i + j] = true;
+        dst_rows[j].push_back(i);
+    }
+}
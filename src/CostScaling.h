@@ -0,0 +1,92 @@
+///
+/// src/algs/CostScaling.h
+///
+/// Cost-scaling push-relabel algorithm (A. V. Goldberg, R. E. Tarjan, DOI 10.1287/moor.15.3.430) for the transportation problem
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef COSTSCALING_H
+#define COSTSCALING_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <limits>
+#include <chrono>
+
+#include "TpInstance.h"
+#include "optresult.h"
+
+///
+/// Min. cost flow on the complete bipartite graph of a t. problem with integer costs:
+/// costs are scaled by m + n + 1, so that the 1-optimal flow of the last refine phase is optimal
+///
+class CostScaling
+{
+public:
+    /// alpha is the eps reduction factor of the refine phases
+    CostScaling(const std::shared_ptr<TpInstance::TProblemData>&, unsigned long long mode = 0, unsigned long long alpha = 8);
+    ~CostScaling();
+
+    optresult solve(double tlim = std::numeric_limits<double>::quiet_NaN(), bool alginfolog = false, bool reptab = false);
+
+    /// flows, row-major m * n
+    const std::vector<TpQuantityType>& getFlows();
+
+private:
+    typedef long long price_type;
+
+    /// eps-optimal flow from a 0-optimal pseudoflow, false if the time limit is reached
+    bool refine(price_type eps, double tlim, const std::chrono::steady_clock::time_point& start);
+    /// push flow from an active node until its excess is 0
+    void discharge(NodeArcIdType v, price_type eps);
+    void relabel(NodeArcIdType v, price_type eps);
+    void setFlow(NodeArcIdType i, NodeArcIdType j, TpQuantityType q);
+
+    inline price_type scaledCost(NodeArcIdType i, NodeArcIdType j) const
+    {
+        return price_type(tpdata_sptr->costs[N * i + j]) * cscale;
+    }
+    /// capacitated lanes, see TpCapacities, are bounded by their capacity as well
+    inline TpQuantityType capacity(NodeArcIdType i, NodeArcIdType j) const
+    {
+        TpQuantityType q = std::min(tpdata_sptr->sources[i], tpdata_sptr->destinations[j]);
+        return tpdata_sptr->capacities.empty() ? q : std::min(q, tpdata_sptr->capacities.at(i, j));
+    }
+
+    std::shared_ptr<TpInstance::TProblemData> tpdata_sptr;
+    NodeArcIdType M;
+    NodeArcIdType N;
+    unsigned long long alpha;
+    price_type cscale;
+
+    /// flows, node excesses and prices, sources first
+    std::vector<TpQuantityType> flows;
+    std::vector<TpQuantityType> excess;
+    std::vector<price_type> prices;
+    /// current arc of each node, the source column or the position in the destination row list
+    std::vector<NodeArcIdType> cur_arc;
+    /// sources with flow to each destination (the residual reverse arcs), entries with 0 flow are removed lazily
+    std::vector<std::vector<NodeArcIdType>> dst_rows;
+    std::vector<bool> in_dst_rows;
+    /// FIFO of active nodes
+    std::deque<NodeArcIdType> active;
+    std::vector<bool> is_active;
+
+    /// counters
+    unsigned long long pushes = 0;
+    unsigned long long relabels = 0;
+};
+
+#endif // COSTSCALING_H
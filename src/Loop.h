@@ -71,6 +71,13 @@ namespace TSimplexData
                                    double* objf_value = nullptr,
                                    double* tot_q = nullptr,
                                    bool remov_if_0 = true, bool just_check = false, bool incr = true);
+        /// bounded vars (capacitated problems): theta and the blocking stone, stone 0 (the entering var) increases from 0
+        /// if incr, decreases from its capacity otherwise; decreasing stones are bounded by their quantity, increasing ones
+        /// by their residual capacity, the blocking stone is 0 if the entering var reaches its other bound first
+        std::pair<double, NodeArcIdType> getBoundedMinQ(const ts_sol& quantities, const TpCapacities& caps, bool incr = true);
+        /// move theta along the loop, the blocking stone leaves the basis (stone 0 stays out of it), other stones
+        /// reaching a bound stay basic
+        void moveBoundedQuantity(double theta, NodeArcIdType blocking, const TpCapacities& caps, ts_sol& quantities, bool incr = true);
                                   
         inline NodeArcIdType getN() { return n; }
         
@@ -14,13 +14,194 @@
 /// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
 ///
 
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+
 #include "MyLog.h"
 
+/// messages in the ring buffer of the asynchronous log, a power of 2
+#define ASYNCLOGCAP 8192
+/// sleep of the writer thread when the ring is empty [ms]
+#define ASYNCLOGSLEEP 1
+
+///
+/// Bounded multi-producer single-consumer ring (D. Vyukov's bounded queue):
+/// a producer claims a cell by a CAS on the enqueue position, the cell sequence number publishes the message
+///
+class AsyncLogRing
+{
+public:
+    AsyncLogRing(std::size_t capacity) : cells(new cell[capacity]), mask(capacity - 1)
+    {
+        for(std::size_t k = 0; k < capacity; k++)
+            cells[k].seq.store(k, std::memory_order_relaxed);
+    }
+
+    /// false if the ring is full, msg is moved otherwise
+    bool push(std::string& msg)
+    {
+        std::size_t pos = enq_pos.load(std::memory_order_relaxed);
+        cell* c;
+        while(true)
+        {
+            c = &cells[pos & mask];
+            std::size_t seq = c->seq.load(std::memory_order_acquire);
+            long long dif = (long long)seq - (long long)pos;
+            if(dif == 0)
+            {
+                if(enq_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if(dif < 0)
+                return false;
+            else
+                pos = enq_pos.load(std::memory_order_relaxed);
+        }
+        c->msg.swap(msg);
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// single consumer, false if empty
+    bool pop(std::string& msg)
+    {
+        cell* c = &cells[deq_pos & mask];
+        if(c->seq.load(std::memory_order_acquire) != deq_pos + 1)
+            return false;
+        msg.swap(c->msg);
+        c->msg.clear();
+        c->seq.store(deq_pos + mask + 1, std::memory_order_release);
+        ++deq_pos;
+        return true;
+    }
+
+private:
+    struct cell
+    {
+        std::atomic<std::size_t> seq;
+        std::string msg;
+    };
+
+    std::unique_ptr<cell[]> cells;
+    std::size_t mask;
+    /// producers' and consumer's positions on different cache lines
+    std::atomic<std::size_t> enq_pos{0};
+    char pad[64];
+    std::size_t deq_pos = 0;
+};
 
-bool init_logging (bool close_it, std::string filename, TLogLevel level, std::string md)
+///
+/// Writer thread of the asynchronous log, stopped (and the ring drained) at close or at program exit
+///
+class AsyncLogWriter
+{
+public:
+    ~AsyncLogWriter()
+    {
+        this->stop();
+    }
+
+    void start()
+    {
+        this->stop();
+        ring.reset(new AsyncLogRing(ASYNCLOGCAP));
+        drained.store(false);
+        accepting.store(true);
+        running.store(true);
+        writer = std::thread(&AsyncLogWriter::run, this);
+        Output2FILE::AsyncOutput().store(&AsyncLogWriter::output, std::memory_order_release);
+    }
+
+    /// no new messages, then the writer thread stops and the messages still queued or being pushed are written
+    void stop()
+    {
+        if(!writer.joinable())
+            return;
+        accepting.store(false);
+        Output2FILE::AsyncOutput().store(nullptr, std::memory_order_release);
+        running.store(false);
+        writer.join();
+        while(true)
+        {
+            bool pushing = producers.load() > 0;
+            this->writeQueued();
+            if(!pushing)
+                break;
+            std::this_thread::yield();
+        }
+        drained.store(true);
+    }
+
+    static AsyncLogWriter& instance()
+    {
+        static AsyncLogWriter wrt;
+        return wrt;
+    }
+
+private:
+    /// a producer that got the output function before stop() either pushes its message before the last drain of
+    /// stop() or, if refused, writes it after the drain; a full ring makes the producer wait, never overtake
+    static bool output(std::string& msg)
+    {
+        AsyncLogWriter& wrt = instance();
+        wrt.producers.fetch_add(1);
+        if(!wrt.accepting.load())
+        {
+            wrt.producers.fetch_sub(1);
+            while(!wrt.drained.load())
+                std::this_thread::yield();
+            return false;
+        }
+        while(!wrt.ring->push(msg))
+            std::this_thread::yield();
+        wrt.producers.fetch_sub(1);
+        return true;
+    }
+
+    /// write all the queued messages, flush once per batch, false if none
+    bool writeQueued()
+    {
+        std::string msg;
+        bool wrote = false;
+        while(ring->pop(msg))
+        {
+            if(Output2FILE::Stream())
+                fprintf(Output2FILE::Stream(), "%s", msg.c_str());
+            wrote = true;
+        }
+        if(wrote && Output2FILE::Stream())
+            fflush(Output2FILE::Stream());
+        return wrote;
+    }
+
+    void run()
+    {
+        while(running.load())
+        {
+            if(!this->writeQueued())
+                std::this_thread::sleep_for(std::chrono::milliseconds(ASYNCLOGSLEEP));
+        }
+    }
+
+    std::unique_ptr<AsyncLogRing> ring;
+    std::atomic<bool> running{false};
+    /// messages are accepted by output(..)
+    std::atomic<bool> accepting{false};
+    /// producers inside output(..)
+    std::atomic<int> producers{0};
+    /// the last messages of stop() are written
+    std::atomic<bool> drained{true};
+    std::thread writer;
+};
+
+
+bool init_logging (bool close_it, std::string filename, TLogLevel level, std::string md, bool async)
 {
     if(close_it)
     {
+        AsyncLogWriter::instance().stop();
         fflush(Output2FILE::Stream());
         return fclose(Output2FILE::Stream());
     }
@@ -32,6 +213,9 @@ bool init_logging (bool close_it, std::string filename, TLogLevel level, std::st
     Output2FILE::Stream() = fopen(logfnss.str().c_str(), md.c_str());
 
     //logging_initialized = true;
+    
+    if(async)
+        AsyncLogWriter::instance().start();
 
-	return true;
+    return true;
 }
@@ -117,6 +117,9 @@ std::string OptLogger<Ts...>::getFormatedLine(const std::tuple<Ts...>& tupline)
 
 //bool logging_initialized = false;
 
-bool init_logging(bool close_it, std::string filename, TLogLevel level = logINFO, std::string md = "w");
+/// with async, FILE_LOG messages go through a lock-free ring buffer to a background thread writing the file,
+/// a message finding the ring full waits for a free cell, so messages keep their order; closing the log
+/// writes the messages still queued
+bool init_logging(bool close_it, std::string filename, TLogLevel level = logINFO, std::string md = "w", bool async = false);
 
 #endif /* MY_LOG_H_ */
@@ -251,6 +251,7 @@ namespace TSimplexData
         NodeArcIdType checkTree();
         
         void getDetachedNodes(std::vector<NodeType>&);
+        void getSubtreeNodes(NodeType nd, std::vector<NodeType>&);
         
         #ifdef LOOPOP
         #ifdef EXPTRACING_2
@@ -275,6 +276,7 @@ namespace TSimplexData
         void computeSubtrees();
         void computeTSpxMultips(const TpInstance::tcosts& cs, std::vector<double>& us, std::vector<double>& vs, NodeType nd = -1);
         std::pair<double,double> computeTSpxObjF(const TpInstance::tcosts& cs, const ts_sol& qs);
+        NodeArcIdType computeTSpxFlows(const std::vector<double>& srcs, const std::vector<double>& dsts, ts_sol& qs, double zq = 0.0);
         std::shared_ptr<std::vector<std::pair<NodeArcIdType, NodeArcIdType>>> getTSpxSolV2();
         void getTSpxSol(const TpInstance::tcosts& cs, std::vector<CellVar>&);
         
@@ -379,6 +379,8 @@ void SpanningTree::computeTSpxMultips(const TpInstance::tcosts& cs, std::vector<
     bool is_col;
     NodeType cnd;
     NodeType bnd;
+    /// dense costs are read directly, sparse ones and slack lanes by lookup
+    const TpCostType* dcs = cs.isDirect() ? cs.begin() : nullptr;
     
     stack.push_back(std::make_pair(nd < 0 ? root_node : nd, nd < 0 ? true : nd < m ? false : true));
     if(nd < 0)
@@ -391,9 +393,9 @@ void SpanningTree::computeTSpxMultips(const TpInstance::tcosts& cs, std::vector<
         while(bnd >= 0)
         {
             if(is_col)
-                us[bnd] = cs[bnd * n + (cnd - m)] - vs[cnd - m];
+                us[bnd] = (dcs != nullptr ? dcs[bnd * n + (cnd - m)] : cs.laneAt(bnd, cnd - m)) - vs[cnd - m];
             else
-                vs[bnd - m] = cs[cnd * n + (bnd - m)] - us[cnd];
+                vs[bnd - m] = (dcs != nullptr ? dcs[cnd * n + (bnd - m)] : cs.laneAt(cnd, bnd - m)) - us[cnd];
             
             stack.push_back(std::make_pair(bnd, !is_col));
             bnd = youngerbro[bnd];
@@ -479,6 +481,50 @@ std::pair<double,double> SpanningTree::computeTSpxObjF(const TpInstance::tcosts&
     return std::make_pair(objf, tsqt);
 }
 
+NodeArcIdType SpanningTree::computeTSpxFlows(const std::vector<double>& srcs, const std::vector<double>& dsts, ts_sol& qs, double zq)
+{
+    if(nodes == 0 || root_node < 0)
+        throw std::runtime_error("Empty tree");
+    
+    /// tree arc flows from supplies and demands, the flow of the arc
+    /// entering a node balances the net supply of the node subtree;
+    /// zero flows are set to zq, the return value is the count of negative flows
+    std::vector<NodeType> order;
+    std::vector<double> excess(nodes, 0.0);
+    NodeArcIdType negct;
+    NodeType cnd;
+    NodeType pnd;
+    NodeType bnd;
+    double q;
+    
+    order.reserve(nodes);
+    order.push_back(root_node);
+    for(NodeArcIdType k = 0; k < order.size(); k++)
+    {
+        cnd = order[k];
+        excess[cnd] = cnd < NodeType(m) ? srcs[cnd] : -dsts[cnd - m];
+        for(bnd = successor[cnd]; bnd >= 0; bnd = youngerbro[bnd])
+            order.push_back(bnd);
+    }
+    
+    negct = 0;
+    for(NodeArcIdType k = order.size() - 1; k > 0; k--)
+    {
+        cnd = order[k];
+        pnd = predecessor[cnd];
+        excess[pnd] += excess[cnd];
+        q = cnd < NodeType(m) ? excess[cnd] : -excess[cnd];
+        if(q < -MYEPS)
+            ++negct;
+        else if(q < MYEPS)
+            q = zq;
+        
+        qs.set(cnd < NodeType(m) ? cnd * n + (pnd - m) : pnd * n + (cnd - m), q);
+    }
+    
+    return negct;
+}
+
 std::shared_ptr<std::vector<std::pair<NodeArcIdType, NodeArcIdType>>> SpanningTree::getTSpxSolV2()
 {
     if(nodes == 0 || root_node < 0)
@@ -756,6 +802,15 @@ void SpanningTree::getDetachedNodes(std::vector<NodeType>& detached_nodes)
     return;
 } 
 
+void SpanningTree::getSubtreeNodes(NodeType nd, std::vector<NodeType>& subtree_nodes)
+{
+    subtree_nodes.clear();
+    subtree_nodes.push_back(nd);
+    for(NodeArcIdType k = 0; k < subtree_nodes.size(); k++)
+        for(NodeType bnd = successor[subtree_nodes[k]]; bnd >= 0; bnd = youngerbro[bnd])
+            subtree_nodes.push_back(bnd);
+}
+
 NodeArcIdType SpanningTree::checkTree()
 {
     NodeArcIdType detached_nodes = 0;
@@ -1067,6 +1122,55 @@ std::pair<double, NodeArcIdType> Loop::getMinQ(const ts_sol& quantities, bool in
     return std::make_pair(min_q, idx);
 }
 
+std::pair<double, NodeArcIdType> Loop::getBoundedMinQ(const ts_sol& quantities, const TpCapacities& caps, bool incr)
+{
+    if(this->size() < 4)
+        throw std::runtime_error("Not a loop size < 4");
+    
+    /// the entering var moves between its bounds, the tree stones block on ties
+    double min_q = caps.at(this->front().i, this->front().j);
+    NodeArcIdType idx = 0;
+    for(NodeArcIdType s = this->size() - 1; s > 0; s--)
+    {
+        const LoopStone& st = (*this)[s];
+        double q = quantities.get(n * st.i + st.j);
+        double bound = ((s & 1) != 0) == incr ? q : caps.at(st.i, st.j) - q;
+        if(min_q > bound + MYEPS)
+            min_q = bound, idx = s;
+    }
+    
+    return std::make_pair(std::max(0.0, min_q), idx);
+}
+
+void Loop::moveBoundedQuantity(double theta, NodeArcIdType blocking, const TpCapacities& caps, ts_sol& quantities, bool incr)
+{
+    for(NodeArcIdType s = 1; s < this->size(); s++)
+    {
+        const LoopStone& st = (*this)[s];
+        NodeArcIdType c = n * st.i + st.j;
+        if(s == blocking)
+        {
+            quantities.remove(c);
+            continue;
+        }
+        if(((s & 1) != 0) == incr)
+        {
+            double q = quantities.get(c) - theta;
+            quantities.set(c, q > MYEPS ? q : 
+                              #ifdef EPSQIS0
+                              0.0
+                              #else
+                              EPSQ
+                              #endif
+                              );
+        }
+        else
+            quantities.set(c, std::min(quantities.get(c) + theta, caps.at(st.i, st.j)));
+    }
+    if(blocking > 0)
+        quantities.set(n * this->front().i + this->front().j, incr ? theta : caps.at(this->front().i, this->front().j) - theta);
+}
+
 std::string Loop::toString(const NodeArcIdType N, const std::vector<double>* q_ptr)
 {
     std::string str("");
@@ -1097,6 +1201,8 @@ NodeArcIdType Loop::moveQuantity(double min_q,
     //double outofbv = remov_if_0 ? std::numeric_limits<double>::quiet_NaN() : 0.0;
     bool plus;
     bool tst_q;
+    /// dense costs are read directly, sparse ones and slack lanes by lookup
+    const TpCostType* dcs = costs.isDirect() ? costs.begin() : nullptr;
 
     zeroed = 0;
     plus = incr ? false : true;
@@ -1105,7 +1211,7 @@ NodeArcIdType Loop::moveQuantity(double min_q,
         c = n * (i = it->i) + (j = it->j);
         if((tst_q = quantities.contains(c)))
             tmp_q = quantities.get(c);
-        tmp_c = costs[c];
+        tmp_c = dcs != nullptr ? dcs[c] : costs.laneAt(i, j);
         
         /// sum
         if(plus)
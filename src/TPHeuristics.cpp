@@ -26,6 +26,8 @@
 #include <stack> 
 #include <set> 
 #include <map> 
+#include <unordered_map> 
+#include <unordered_set> 
 #include <cmath> 
 #include <iterator>
 #include <iostream>
@@ -44,6 +46,18 @@
 #define GETOPTT(start) ((double)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0)
 #define GETOPTTMS(start) double((std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()) / 1000.0)
 
+/// grid side of the coarsest problem of the multiscale rule
+#define MSMINSIDE 8
+/// Sinkhorn rule: first and last entropic regularization (fractions of the cost range),
+/// regularization decrease factor, iterations per regularization value, tolerance on the L1 error of the marginals,
+/// min. plan entry (times m + n) of the rounding candidates
+#define SKEPS0 0.0625
+#define SKEPSMIN 4.0e-3
+#define SKEPSF 0.25
+#define SKMAXITER 5
+#define SKTOL 1.0e-3
+#define SKPLANTHR 1.0e-2
+
 
 optresult TSimplex::nwcorner(const std::shared_ptr<tplex_alg_data>& tplxd_sptr)
 {
@@ -199,8 +213,8 @@ optresult TSimplex::matrix_min_rule(const std::shared_ptr<tplex_alg_data>& tplxd
     initsrt_ms = GETOPTTMS(start);
     if(verbose_log) { FILE_LOG(logINFO) << "Data initialization time >> " << std::fixed << std::setprecision(3) << initsrt_ms << " [ms]"; }
     
-    /// main loop
-    VCT = M * N;
+    /// main loop, over the arcs only of sparse instances
+    VCT = tplxd_sptr->vdata.cs.size();
     c = iter = i = j = 0;
     tot_cost = tot_q = 0.0;
     tplxd_sptr->partial_basis_size = 0;
@@ -245,6 +259,59 @@ optresult TSimplex::matrix_min_rule(const std::shared_ptr<tplex_alg_data>& tplxd
         ++c;
     }
     while(c < VCT && iter < M + N - 1);
+    
+    /// sparse instances: the basis is completed north-west corner-wise with artificial vars (big M lanes)
+    NodeArcIdType artificial = 0;
+    if(iter < M + N - 1)
+    {
+        std::vector<NodeArcIdType> act_rows;
+        std::vector<NodeArcIdType> act_cols;
+        for(NodeArcIdType r = 0; r < M; r++)
+            if(nodes[r])
+                act_rows.push_back(r);
+        for(NodeArcIdType k = 0; k < N; k++)
+            if(nodes[M + k])
+                act_cols.push_back(k);
+        
+        auto rit = act_rows.begin();
+        auto cit = act_cols.begin();
+        while(iter < M + N - 1 && rit != act_rows.end() && cit != act_cols.end())
+        {
+            i = *rit;
+            j = *cit;
+            min_q = std::min(q_at_srcs[i], q_at_dsts[j]);
+            q_at_srcs[i] -= min_q;
+            q_at_dsts[j] -= min_q;
+            
+            tot_q += min_q;
+            tot_cost += tpdata_sptr->costs[N * i + j] * min_q;
+            tplxd_sptr->quantities.set(N * i + j, !(min_q > MYEPS) 
+                                                    ? 
+                                                    #ifdef EPSQIS0
+                                                    0.0
+                                                    #else
+                                                    EPSQ
+                                                    #endif
+                                                    : min_q);
+            tplxd_sptr->rows[i].push_back(CellVar(i, j, tpdata_sptr->costs[N * i + j], 0.0));
+            tplxd_sptr->cols[j].push_back(CellVar(i, j, tpdata_sptr->costs[N * i + j], 0.0));
+            tplxd_sptr->solution.push_back(CellVar(i, j, tpdata_sptr->costs[N * i + j], 0.0));
+            
+            /// the last active row or column stays until the end
+            if(std::next(rit) == act_rows.end())
+                nodes[M + j] = false;
+            else if(std::next(cit) == act_cols.end())
+                nodes[i] = false;
+            else
+                nodes[std::round(q_at_srcs[i]) < MYEPS ? i : M + j] = false;
+            
+            nodes[i] ? ++cols_rem : ++rows_rem;
+            nodes[i] ? ++cit : ++rit;
+            ++iter;
+            ++artificial;
+        }
+        FILE_LOG(logINFO) << "MMR ::: artificial vars >> " << artificial;
+    }
         
     /// get opt time
     opt_sec = GETOPTT(start);
@@ -270,3 +337,658 @@ optresult TSimplex::matrix_min_rule(const std::shared_ptr<tplex_alg_data>& tplxd
     
     return optres;
 }
+
+optresult TSimplex::capacitated_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr)
+{
+    /// local vars
+    const TpCapacities& caps = tpdata_sptr->capacities;
+    tplex_alg_data::var_data& vdata = tplxd_sptr->vdata;
+    std::unordered_map<NodeArcIdType, TpQuantityType> flows;
+    std::vector<NodeArcIdType> lanes;
+    std::unordered_set<NodeArcIdType> basis;
+    NodeArcIdType M;
+    NodeArcIdType N;
+    double tot_cost;
+    double tot_q;
+    double initsrt_ms = std::numeric_limits<double>::quiet_NaN();
+    
+    /// loging
+    if(verbose_log) { FILE_LOG(logINFO)  << "Compute solution with capacitated MMR method ... "; }
+    
+    /// start chrono
+    auto start = std::chrono::steady_clock::now();
+    M = tpdata_sptr->m;
+    N = tpdata_sptr->n;
+    if(vdata.cs.empty())
+    {
+        if(verbose_log) { FILE_LOG(logINFO) << "Sort problem vars ..."; }
+        auto ivdst = std::chrono::steady_clock::now();
+        this->initVarData(vdata);
+        FILE_LOG(logINFO)  << "Data structure initialization time >> " << GETOPTTMS(ivdst) << " [ms] ::: problem vars " << (algcfg.partition_factor < MYEPS ? "*sorted*" : "*partitioned*");
+    }
+    initsrt_ms = GETOPTTMS(start);
+    
+    /// feasible flow, MMR order first
+    if(!tpdata_sptr->capacitatedFlow(vdata.is, vdata.js, flows, lanes))
+        throw std::runtime_error("Capacitated problem ::: no feasible flow within the capacities");
+    
+    /// vars strictly between their bounds: a forest (union-find and tree adjacency), a var closing a cycle moves
+    /// quantity along it in the direction that does not increase the cost until a var of the cycle reaches a bound
+    std::vector<NodeArcIdType> uf(M + N);
+    std::iota(uf.begin(), uf.end(), 0);
+    auto find = [&uf](NodeArcIdType v) {
+        while(uf[v] != v)
+            v = uf[v] = uf[uf[v]];
+        return v;
+    };
+    std::vector<std::vector<NodeArcIdType>> adj(M + N);
+    auto link = [&](NodeArcIdType i, NodeArcIdType j, bool add) {
+        if(add)
+        {
+            adj[i].push_back(M + j);
+            adj[M + j].push_back(i);
+            basis.insert(N * i + j);
+            return;
+        }
+        adj[i].erase(std::find(adj[i].begin(), adj[i].end(), M + j));
+        adj[M + j].erase(std::find(adj[M + j].begin(), adj[M + j].end(), i));
+        basis.erase(N * i + j);
+    };
+    std::vector<NodeArcIdTypeSGND> pred(M + N, -1);
+    std::vector<NodeArcIdType> visited;
+    std::vector<NodeArcIdType> path;
+    NodeArcIdType cycles = 0;
+    for(auto it = lanes.begin(); it != lanes.end(); it++)
+    {
+        NodeArcIdType i = *it / N;
+        NodeArcIdType j = *it % N;
+        TpQuantityType q = flows[*it];
+        if(!(q > MYEPS) || !(q < caps.at(i, j) - MYEPS))
+            continue;
+        NodeArcIdType ri = find(i);
+        NodeArcIdType rj = find(M + j);
+        if(ri != rj)
+        {
+            uf[ri] = rj;
+            link(i, j, true);
+            continue;
+        }
+        
+        /// tree path i, ..., M + j (BFS), its lanes alternate decreasing and increasing as lane (i, j) increases
+        visited.assign(1, i);
+        pred[i] = i;
+        for(std::size_t h = 0; pred[M + j] < 0; h++)
+        {
+            for(auto nb = adj[visited[h]].begin(); nb != adj[visited[h]].end(); nb++)
+            {
+                if(pred[*nb] < 0)
+                {
+                    pred[*nb] = visited[h];
+                    visited.push_back(*nb);
+                }
+            }
+        }
+        path.clear();
+        for(NodeArcIdType v = M + j; v != i; v = pred[v])
+            path.push_back(v);
+        path.push_back(i);
+        std::reverse(path.begin(), path.end());
+        for(auto v = visited.begin(); v != visited.end(); v++)
+            pred[*v] = -1;
+        
+        auto lane = [&](std::size_t t) {
+            return path[t] < M ? N * path[t] + path[t + 1] - M : N * path[t + 1] + path[t] - M;
+        };
+        double delta = tpdata_sptr->costs[*it];
+        for(std::size_t t = 0; t + 1 < path.size(); t++)
+            delta += (t % 2 ? 1.0 : -1.0) * tpdata_sptr->costs[lane(t)];
+        double dir = delta > 0.0 ? -1.0 : 1.0;
+        
+        /// theta, lane (i, j) blocks on ties
+        double theta = dir > 0.0 ? caps.at(i, j) - q : q;
+        std::ptrdiff_t blocking = -1;
+        for(std::size_t t = 0; t + 1 < path.size(); t++)
+        {
+            NodeArcIdType c = lane(t);
+            double x = flows[c];
+            double bound = (t % 2 ? dir : -dir) > 0.0 ? caps.at(c / N, c % N) - x : x;
+            if(theta > bound + MYEPS)
+                theta = bound, blocking = t;
+        }
+        flows[*it] += dir * theta;
+        for(std::size_t t = 0; t + 1 < path.size(); t++)
+            flows[lane(t)] += (t % 2 ? dir : -dir) * theta;
+        if(blocking >= 0)
+        {
+            NodeArcIdType c = lane(blocking);
+            link(c / N, c % N, false);
+            link(i, j, true);
+        }
+        ++cycles;
+    }
+    
+    /// nonbasic vars at their upper bound
+    vdata.upper.clear();
+    vdata.upper_pos.assign(caps.size(), -1);
+    for(auto it = lanes.begin(); it != lanes.end(); it++)
+    {
+        std::ptrdiff_t k = caps.find(*it / N, *it % N);
+        if(k >= 0 && flows[*it] > MYEPS && !(flows[*it] < caps.capacity(k) - MYEPS) && !basis.count(*it))
+            vdata.setUpper(k, true);
+    }
+    
+    /// spanning tree: the components are linked to row 0, then to column 0, by degenerate vars or vars at their upper bound
+    for(NodeArcIdType j = 0; j < N; j++)
+    {
+        if(find(M + j) != find(0))
+        {
+            uf[find(M + j)] = find(0);
+            link(0, j, true);
+        }
+    }
+    for(NodeArcIdType i = 1; i < M; i++)
+    {
+        if(find(i) != find(M))
+        {
+            uf[find(i)] = find(M);
+            link(i, 0, true);
+        }
+    }
+    
+    /// basis and solution
+    tot_cost = tot_q = 0.0;
+    tplxd_sptr->partial_basis_size = 0;
+    tplxd_sptr->solution.reserve(M + N - 1);
+    for(auto it = basis.begin(); it != basis.end(); it++)
+    {
+        NodeArcIdType i = *it / N;
+        NodeArcIdType j = *it % N;
+        auto f = flows.find(*it);
+        TpQuantityType q = f == flows.end() ? 0.0 : f->second;
+        std::ptrdiff_t k = caps.find(i, j);
+        if(k >= 0)
+            vdata.setUpper(k, false);
+        
+        tot_q += q;
+        tot_cost += tpdata_sptr->costs[*it] * q;
+        tplxd_sptr->quantities.set(*it, !(q > MYEPS) 
+                                        ? 
+                                        #ifdef EPSQIS0
+                                        0.0
+                                        #else
+                                        EPSQ
+                                        #endif
+                                        : q);
+        tplxd_sptr->rows[i].push_back(CellVar(i, j, tpdata_sptr->costs[*it], 0.0));
+        tplxd_sptr->cols[j].push_back(CellVar(i, j, tpdata_sptr->costs[*it], 0.0));
+        tplxd_sptr->solution.push_back(CellVar(i, j, tpdata_sptr->costs[*it], 0.0));
+    }
+    for(auto it = vdata.upper.begin(); it != vdata.upper.end(); it++)
+    {
+        tot_q += caps.capacity(*it);
+        tot_cost += tpdata_sptr->costs[N * caps.row(*it) + caps.col(*it)] * caps.capacity(*it);
+    }
+    FILE_LOG(logINFO) << "Capacitated MMR ::: canceled cycles >> " << cycles << " ::: vars at the upper bound >> " << vdata.upper.size();
+    
+    /// return value
+    optresult optres;
+    optres.obj_value = tot_cost;
+    optres.run_time = GETOPTT(start);
+    optres.tags.resize(2);
+    optres.tags[1] = std::string("CMMR");
+    optres.integer_values.resize(1);
+    optres.integer_values[0] = basis.size();
+    optres.double_values.resize(3, std::numeric_limits<double>::quiet_NaN());
+    optres.double_values[0] = tot_q;
+    optres.double_values[1] = initsrt_ms;
+    optres.double_values[2] = GETOPTTMS(start);
+    
+    if(verbose_log)
+    {
+        FILE_LOG(logINFO)  << "Capacitated MMR method t cost = " << std::setprecision(1) << std::fixed << optres.obj_value << ", shipped q = " << tot_q
+                           << ", opt time = " << std::setprecision(3) << std::fixed << optres.run_time << " [s], " << basis.size() << " basis vars";
+    }
+    
+    return optres;
+}
+
+optresult TSimplex::multiscale_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr)
+{
+    /// local vars
+    std::vector<TpQuantityType> c_srcs;
+    std::vector<TpQuantityType> c_dsts;
+    std::vector<TpCostType> c_costs;
+    std::vector<NodeArcIdType> c_rows;
+    std::vector<NodeArcIdType> c_cols;
+    std::vector<std::vector<NodeArcIdType>> c_row_children;
+    std::vector<std::vector<NodeArcIdType>> c_col_children;
+    std::vector<CellVar> first_vars;
+    NodeArcIdType M;
+    NodeArcIdType N;
+    NodeArcIdType SM;
+    NodeArcIdType SN;
+    NodeArcIdType CM;
+    NodeArcIdType CN;
+    NodeArcIdType i;
+    NodeArcIdType j;
+    double opt_sec;
+    double coarse_ms;
+    
+    M = tpdata_sptr->m;
+    N = tpdata_sptr->n;
+    if(!tpdata_sptr->costs.isDirect())
+    {
+        FILE_LOG(logINFO) << "Multiscale rule ::: sparse or unbalanced instance ::: MMR";
+        return this->matrix_min_rule(tplxd_sptr);
+    }
+    /// sources and destinations are square grids, of the original problem if reduced
+    SM = std::llround(std::sqrt(tpdata_sptr->reduced ? tpdata_sptr->m_orgn : M));
+    SN = std::llround(std::sqrt(tpdata_sptr->reduced ? tpdata_sptr->n_orgn : N));
+    if(SM * SM != (tpdata_sptr->reduced ? tpdata_sptr->m_orgn : M) || SN * SN != (tpdata_sptr->reduced ? tpdata_sptr->n_orgn : N)
+       || SM < 2 * MSMINSIDE || SN < 2 * MSMINSIDE)
+    {
+        FILE_LOG(logINFO) << "Multiscale rule ::: no square grids of side >= " << 2 * MSMINSIDE << " (m = " << M << ", n = " << N << ") ::: MMR";
+        return this->matrix_min_rule(tplxd_sptr);
+    }
+    
+    /// loging
+    if(verbose_log) { FILE_LOG(logINFO)  << "Compute solution with multiscale rule ... "; }
+    
+    /// start chrono
+    auto start = std::chrono::steady_clock::now();
+    
+    /// 2x2 aggregation of the grids
+    CM = ((SM + 1) / 2) * ((SM + 1) / 2);
+    CN = ((SN + 1) / 2) * ((SN + 1) / 2);
+    c_rows.resize(M);
+    c_cols.resize(N);
+    c_srcs.assign(CM, 0.0);
+    c_dsts.assign(CN, 0.0);
+    c_row_children.resize(CM);
+    c_col_children.resize(CN);
+    for(i = 0; i < M; i++)
+    {
+        NodeArcIdType oi = tpdata_sptr->reduced ? tpdata_sptr->sources_map[i] : i;
+        c_rows[i] = (oi / SM / 2) * ((SM + 1) / 2) + (oi % SM) / 2;
+        c_srcs[c_rows[i]] += tpdata_sptr->sources[i];
+        c_row_children[c_rows[i]].push_back(i);
+    }
+    for(j = 0; j < N; j++)
+    {
+        NodeArcIdType oj = tpdata_sptr->reduced ? tpdata_sptr->destinations_map[j] : j;
+        c_cols[j] = (oj / SN / 2) * ((SN + 1) / 2) + (oj % SN) / 2;
+        c_dsts[c_cols[j]] += tpdata_sptr->destinations[j];
+        c_col_children[c_cols[j]].push_back(j);
+    }
+    /// coarse costs are the average costs of the children
+    c_costs.assign(CM * CN, 0.0);
+    for(i = 0; i < M; i++)
+        for(j = 0; j < N; j++)
+            c_costs[c_rows[i] * CN + c_cols[j]] += tpdata_sptr->costs[N * i + j];
+    for(i = 0; i < CM; i++)
+        for(j = 0; j < CN; j++)
+            c_costs[i * CN + j] = c_row_children[i].empty() || c_col_children[j].empty()
+                                  ?
+                                  tpdata_sptr->maxc
+                                  :
+                                  c_costs[i * CN + j] / (c_row_children[i].size() * c_col_children[j].size());
+    
+    /// solve the coarse problem, multiscale again down to the coarsest grid
+    FILE_LOG(logINFO) << "Multiscale rule ::: coarse problem " << CM << " x " << CN << " ...";
+    TpInstance c_inst(CM, CN, c_srcs.data(), c_dsts.data(), c_costs.data());
+    TSimplex c_tspx(c_inst.getInstanceData(), algcfg.mode, algcfg.wsf, algcfg.ws2f, algcfg.pf);
+    c_tspx.setThreads(algcfg.threads);
+    c_tspx.setCancelFlag(cancel_flag);
+    optresult c_optres = c_tspx.tsimplex();
+    coarse_ms = GETOPTTMS(start);
+    FILE_LOG(logINFO) << "Multiscale rule ::: coarse problem " << CM << " x " << CN
+                      << " ::: Obj F >> " << std::setprecision(0) << std::fixed << c_optres.obj_value
+                      << " ::: time >> " << std::setprecision(3) << coarse_ms << " [ms]";
+    
+    /// fine vars of the coarse basis, by cost
+    auto c_arcs_sptr = c_tspx.getAlgData()->vdata.spat_sptr->getTSpxSolV2();
+    for(auto it = c_arcs_sptr->begin(); it != c_arcs_sptr->end(); it++)
+        for(auto iit = c_row_children[it->first].begin(); iit != c_row_children[it->first].end(); iit++)
+            for(auto jit = c_col_children[it->second].begin(); jit != c_col_children[it->second].end(); jit++)
+                first_vars.push_back(CellVar(*iit, *jit, tpdata_sptr->costs[N * (*iit) + (*jit)], 0.0));
+    std::sort(first_vars.begin(), first_vars.end(), [](const CellVar& a, const CellVar& b) { return a.cost < b.cost; });
+    
+    /// basis by MMR from the fine vars of the coarse basis
+    optresult optres = this->first_vars_min_rule(tplxd_sptr, first_vars);
+    
+    /// get opt time
+    opt_sec = GETOPTT(start);
+    
+    /// return value
+    optres.run_time = opt_sec;
+    optres.tags[1] = std::string("MS");
+    optres.double_values[1] = coarse_ms;
+    optres.double_values[2] = GETOPTTMS(start);
+    
+    if(verbose_log)
+    {
+        FILE_LOG(logINFO)  << "Multiscale rule t cost = " << std::setprecision(1) << std::fixed << optres.obj_value << ", shipped q = " << optres.double_values[0]
+                           << ", opt time = " << std::setprecision(3) << std::fixed << optres.run_time << " [s], " << optres.integer_values[0] << " iterations";
+    }
+    
+    return optres;
+}
+
+optresult TSimplex::sinkhorn_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr)
+{
+    /// local vars
+    std::vector<double> as;
+    std::vector<double> bs;
+    std::vector<double> fs;
+    std::vector<double> gs;
+    std::vector<double> col_max;
+    std::vector<double> col_sum;
+    std::vector<std::vector<CellVar>> row_vars;
+    std::vector<CellVar> first_vars;
+    NodeArcIdType M;
+    NodeArcIdType N;
+    unsigned long iter;
+    unsigned long tot_iter;
+    double range;
+    double eps;
+    double err;
+    double thr;
+    double opt_sec;
+    double sk_ms;
+    
+    /// dense kernel of the stored costs, big M lanes would dominate it
+    if(!tpdata_sptr->costs.isDirect())
+    {
+        FILE_LOG(logINFO) << "Sinkhorn rule ::: sparse or unbalanced instance ::: MMR";
+        return this->matrix_min_rule(tplxd_sptr);
+    }
+    
+    /// loging
+    if(verbose_log) { FILE_LOG(logINFO)  << "Compute solution with Sinkhorn rule ... "; }
+    
+    /// start chrono
+    auto start = std::chrono::steady_clock::now();
+    
+    /// marginals as probabilities
+    M = tpdata_sptr->m;
+    N = tpdata_sptr->n;
+    double tot_src_q = std::accumulate(tpdata_sptr->sources.begin(), tpdata_sptr->sources.end(), 0.0);
+    double tot_dst_q = std::accumulate(tpdata_sptr->destinations.begin(), tpdata_sptr->destinations.end(), 0.0);
+    as.resize(M);
+    bs.resize(N);
+    for(NodeArcIdType i = 0; i < M; i++)
+        as[i] = std::log(std::max(tpdata_sptr->sources[i] / tot_src_q, MYEPS * MYEPS));
+    for(NodeArcIdType j = 0; j < N; j++)
+        bs[j] = std::log(std::max(tpdata_sptr->destinations[j] / tot_dst_q, MYEPS * MYEPS));
+    
+    /// log-domain Sinkhorn iterations with decreasing regularization
+    const TpCostType* cs = tpdata_sptr->costs.begin();
+    range = tpdata_sptr->maxc - tpdata_sptr->minc > MYEPS ? tpdata_sptr->maxc - tpdata_sptr->minc : 1.0;
+    fs.assign(M, 0.0);
+    gs.assign(N, 0.0);
+    col_max.resize(N);
+    col_sum.resize(N);
+    tot_iter = 0;
+    err = std::numeric_limits<double>::max();
+    for(eps = range * SKEPS0; ; eps *= SKEPSF)
+    {
+        eps = std::max(eps, range * SKEPSMIN);
+        for(iter = 0; iter < SKMAXITER; iter++, tot_iter++)
+        {
+            /// rows: f_i = eps log a_i - eps LSE_j((g_j - c_ij) / eps), the error of the current row marginals comes for free
+            err = 0.0;
+            #pragma omp parallel for schedule(static) num_threads(algcfg.threads) reduction(+:err)
+            for(NodeArcIdType i = 0; i < M; i++)
+            {
+                const TpCostType* crow = cs + N * i;
+                double mx = std::numeric_limits<double>::lowest();
+                double sm = 0.0;
+                for(NodeArcIdType j = 0; j < N; j++)
+                    mx = std::max(mx, gs[j] - crow[j]);
+                for(NodeArcIdType j = 0; j < N; j++)
+                    sm += std::exp((gs[j] - crow[j] - mx) / eps);
+                err += std::abs(std::exp((fs[i] + mx) / eps) * sm - std::exp(as[i]));
+                fs[i] = eps * as[i] - mx - eps * std::log(sm);
+            }
+            /// cols: g_j = eps log b_j - eps LSE_i((f_i - c_ij) / eps), row-major sweeps on column blocks
+            #pragma omp parallel for schedule(static) num_threads(algcfg.threads)
+            for(NodeArcIdType jb = 0; jb < N; jb += 256)
+            {
+                NodeArcIdType je = std::min(N, jb + 256);
+                std::fill(col_max.begin() + jb, col_max.begin() + je, std::numeric_limits<double>::lowest());
+                std::fill(col_sum.begin() + jb, col_sum.begin() + je, 0.0);
+                for(NodeArcIdType i = 0; i < M; i++)
+                    for(NodeArcIdType j = jb; j < je; j++)
+                        col_max[j] = std::max(col_max[j], fs[i] - cs[N * i + j]);
+                for(NodeArcIdType i = 0; i < M; i++)
+                    for(NodeArcIdType j = jb; j < je; j++)
+                        col_sum[j] += std::exp((fs[i] - cs[N * i + j] - col_max[j]) / eps);
+                for(NodeArcIdType j = jb; j < je; j++)
+                    gs[j] = eps * bs[j] - col_max[j] - eps * std::log(col_sum[j]);
+            }
+            if(err < SKTOL)
+                break;
+        }
+        if(!(eps > range * SKEPSMIN))
+            break;
+    }
+    sk_ms = GETOPTTMS(start);
+    FILE_LOG(logINFO) << "Sinkhorn rule ::: iters >> " << tot_iter << " ::: last reg. >> " << eps
+                      << " ::: marginal L1 err. >> " << std::setprecision(6) << err
+                      << " ::: time >> " << std::setprecision(3) << sk_ms << " [ms]";
+    
+    /// rounding: the largest plan entries first
+    thr = SKPLANTHR / (M + N);
+    row_vars.resize(M);
+    #pragma omp parallel for schedule(static) num_threads(algcfg.threads)
+    for(NodeArcIdType i = 0; i < M; i++)
+    {
+        double p;
+        for(NodeArcIdType j = 0; j < N; j++)
+        {
+            if((p = std::exp((fs[i] + gs[j] - cs[N * i + j]) / eps)) >= thr)
+                row_vars[i].push_back(CellVar(i, j, cs[N * i + j], p));
+        }
+    }
+    for(NodeArcIdType i = 0; i < M; i++)
+        first_vars.insert(first_vars.end(), row_vars[i].begin(), row_vars[i].end());
+    std::sort(first_vars.begin(), first_vars.end(), [](const CellVar& a, const CellVar& b) { return a.rc > b.rc; });
+    
+    /// basis by MMR from the plan entries
+    optresult optres = this->first_vars_min_rule(tplxd_sptr, first_vars);
+    
+    /// get opt time
+    opt_sec = GETOPTT(start);
+    
+    /// return value
+    optres.run_time = opt_sec;
+    optres.tags[1] = std::string("SINKHORN");
+    optres.double_values[1] = sk_ms;
+    optres.double_values[2] = GETOPTTMS(start);
+    
+    if(verbose_log)
+    {
+        FILE_LOG(logINFO)  << "Sinkhorn rule t cost = " << std::setprecision(1) << std::fixed << optres.obj_value << ", shipped q = " << optres.double_values[0]
+                           << ", plan vars = " << first_vars.size()
+                           << ", opt time = " << std::setprecision(3) << std::fixed << optres.run_time << " [s], " << optres.integer_values[0] << " iterations";
+    }
+    
+    return optres;
+}
+
+optresult TSimplex::first_vars_min_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr,
+                                        const std::vector<CellVar>& first_vars)
+{
+    /// local vars
+    std::vector<TpQuantityType> q_at_srcs;
+    std::vector<TpQuantityType> q_at_dsts;
+    std::vector<bool> nodes;
+    NodeArcIdType rows_rem;
+    NodeArcIdType cols_rem;
+    NodeArcIdType M;
+    NodeArcIdType N;
+    NodeArcIdType c;
+    NodeArcIdType i;
+    NodeArcIdType j;
+    unsigned long iter;
+    double min_q;
+    double tot_cost;
+    double tot_q;
+    
+    /// start chrono
+    auto start = std::chrono::steady_clock::now();
+    
+    /// init. data
+    q_at_srcs = tpdata_sptr->sources;
+    q_at_dsts = tpdata_sptr->destinations;
+    rows_rem = cols_rem = 0;
+    M = tpdata_sptr->m;
+    N = tpdata_sptr->n;
+    nodes = std::vector<bool>(M + N, true);
+    tplxd_sptr->solution.reserve(M + N - 1);
+    if(tplxd_sptr->vdata.cs.empty())
+        this->initVarData(tplxd_sptr->vdata);
+    
+    /// MMR step
+    auto basis_var = [&](NodeArcIdType vi, NodeArcIdType vj)
+    {
+        min_q = std::min(q_at_srcs[vi], q_at_dsts[vj]);
+        q_at_srcs[vi] -= min_q;
+        q_at_dsts[vj] -= min_q;
+
+        tot_q += min_q;
+        tot_cost += tpdata_sptr->costs[N * vi + vj] * min_q;
+        tplxd_sptr->quantities.set(N * vi + vj, !(min_q > MYEPS) 
+                                                ? 
+                                                #ifdef EPSQIS0
+                                                0.0
+                                                #else
+                                                EPSQ
+                                                #endif
+                                                : min_q);
+
+        tplxd_sptr->rows[vi].push_back(CellVar(vi, vj, tpdata_sptr->costs[N * vi + vj], 0.0));
+        tplxd_sptr->cols[vj].push_back(CellVar(vi, vj, tpdata_sptr->costs[N * vi + vj], 0.0));
+        tplxd_sptr->solution.push_back(CellVar(vi, vj, tpdata_sptr->costs[N * vi + vj], 0.0));
+        
+        if(std::round(q_at_srcs[vi]) < MYEPS && std::round(q_at_dsts[vj]) < MYEPS)
+            nodes[cols_rem > rows_rem ? vi : M + vj] = false;
+        else
+            nodes[std::round(q_at_srcs[vi]) < MYEPS ? vi : M + vj] = false;
+        
+        nodes[vi] ? ++cols_rem : ++rows_rem;
+        iter++;
+    };
+    
+    /// main loop, first the given vars, then all vars
+    iter = 0;
+    tot_cost = tot_q = 0.0;
+    tplxd_sptr->partial_basis_size = 0;
+    for(c = 0; c < first_vars.size() && iter < M + N - 1; c++)
+    {
+        if(nodes[first_vars[c].i] && nodes[M + first_vars[c].j])
+            basis_var(first_vars[c].i, first_vars[c].j);
+    }
+    for(c = 0; c < tplxd_sptr->vdata.is.size() && iter < M + N - 1; c++)
+    {
+        i = tplxd_sptr->vdata.is[c];
+        j = tplxd_sptr->vdata.js[c];
+        if(nodes[i] && nodes[M + j])
+            basis_var(i, j);
+    }
+    
+    /// return value
+    optresult optres;
+    optres.obj_value = tot_cost;
+    optres.run_time = GETOPTT(start);
+    optres.tags.resize(2);
+    optres.tags[1] = std::string("MMR");
+    optres.integer_values.resize(1);
+    optres.integer_values[0] = iter;
+    optres.double_values.resize(3, std::numeric_limits<double>::quiet_NaN());
+    optres.double_values[0] = tot_q;
+    optres.double_values[2] = GETOPTTMS(start);
+    
+    return optres;
+}
+
+optresult TSimplex::basis_solution(const std::shared_ptr<tplex_alg_data>& tplxd_sptr,
+                                   const std::shared_ptr<SpanningTree>& bspat_sptr)
+{
+    /// local vars
+    NodeArcIdType negct;
+    long dual_pivots;
+    double opt_sec;
+    
+    /// loging
+    if(verbose_log) { FILE_LOG(logINFO)  << "Compute solution of the given basis ... "; }
+
+    /// start chrono
+    auto start = std::chrono::steady_clock::now();
+    
+    /// flows on the tree arcs
+    negct = bspat_sptr->computeTSpxFlows(tpdata_sptr->sources, tpdata_sptr->destinations, tplxd_sptr->quantities,
+                                         #ifdef EPSQIS0
+                                         0.0
+                                         #else
+                                         EPSQ
+                                         #endif
+                                         );
+    /// restore primal feasibility
+    dual_pivots = 0;
+    if(negct)
+    {
+        FILE_LOG(logINFO) << "Given basis has " << negct << " negative flows ::: dual simplex pivots ...";
+        dual_pivots = this->dualPivoting(tplxd_sptr, bspat_sptr);
+        negct = dual_pivots < 0 ? 1 : 0;
+    }
+    bspat_sptr->resetTreeColor();
+    auto objf_and_tsq = bspat_sptr->computeTSpxObjF(tpdata_sptr->costs, tplxd_sptr->quantities);
+    
+    /// get opt time
+    opt_sec = GETOPTT(start);
+
+    /// return value
+    optresult optres;
+    optres.obj_value = objf_and_tsq.first;
+    optres.run_time = opt_sec;
+    optres.tags.resize(2);
+    optres.tags[1] = std::string(dual_pivots ? "DUALSPX" : "BASIS");
+    optres.integer_values.resize(1);
+    optres.integer_values[0] = negct ? 0 : tpdata_sptr->m + tpdata_sptr->n - 1;
+    optres.double_values.resize(3, std::numeric_limits<double>::quiet_NaN());
+    optres.double_values[0] = objf_and_tsq.second;
+    optres.double_values[2] = GETOPTTMS(start);
+    
+    /// not a feasible basis
+    if(negct)
+    {
+        FILE_LOG(logINFO) << "Dual simplex failed to restore primal feasibility";
+        tplxd_sptr->clearSol();
+    }
+    else
+    {   /// basis by rows and cols, the arcs of the tree
+        NodeArcIdType M = tpdata_sptr->m;
+        NodeArcIdType N = tpdata_sptr->n;
+        SpanningTree::NodeType pnd;
+        for(NodeArcIdType i = 0; i < M; i++)
+            tplxd_sptr->rows[i].clear();
+        for(NodeArcIdType j = 0; j < N; j++)
+            tplxd_sptr->cols[j].clear();
+        for(NodeArcIdType nd = 0; nd < M + N; nd++)
+        {
+            if((pnd = bspat_sptr->getPredecessor(nd)) < 0)
+                continue;
+            NodeArcIdType i = nd < M ? nd : pnd;
+            NodeArcIdType j = nd < M ? pnd - M : nd - M;
+            tplxd_sptr->rows[i].push_back(CellVar(i, j, tpdata_sptr->costs[N * i + j], 0.0));
+            tplxd_sptr->cols[j].push_back(CellVar(i, j, tpdata_sptr->costs[N * i + j], 0.0));
+        }
+        if(dual_pivots)
+        {
+            FILE_LOG(logINFO) << "Dual simplex ::: pivots >> " << dual_pivots << " ::: time >> " << optres.double_values[2] << " [ms]";
+        }
+    }
+    
+    return optres;
+}
@@ -57,6 +57,7 @@
 #include "TSimplex.h"
 #include "util.h"
 
+#include "itertrace.h"
 #include "MyLog.h"
 
 
@@ -94,6 +95,19 @@
 
 #define DTMRK_SIGNIFIMPR 1000000.0
 
+/// entering vars per thread in a parallel loop batch
+#define PARPIVBATCH 16
+
+/// reduced costs computed between two stop checks of a pricing scan
+#define STOPCHECKCELLS 65536
+
+/// stored costs per block of the row suffix min. costs of rules 0 and 1
+#define ROWSUFBLK 64
+
+/// keep the basis by rows and cols of tplex_alg_data up to date in the pivots, O(min row/col degree) per pivot,
+/// off since nothing reads it after the spanning tree is built
+#define UPDRWCLSOL false
+
 #define GETOPTT(start) ((double)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0)
 #define GETOPTTMS(start) ((double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0)
 #define GETOPTTMS6(start) ((double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1.0e6)
@@ -177,6 +191,10 @@ TSimplex::TSimplex(const std::shared_ptr<TpInstance::TProblemData>& idatsptr, un
         algcfg.rccpol = (mode / 1000 % 10);
         algcfg.init_sol_method = (mode / 10000 % 10);
     }
+    algcfg.mode = mode;
+    algcfg.wsf = wsf;
+    algcfg.ws2f = ws2f;
+    algcfg.pf = pf;
     /// Parameter 'alpha' of the initial clustering
     algcfg.window_size_factor = wsf == 0 || wsf * (tpdata_sptr->m + tpdata_sptr->n) > tpdata_sptr->m * tpdata_sptr->n ? std::numeric_limits<unsigned long long>::max() : wsf;
     
@@ -204,6 +222,9 @@ TSimplex::TSimplex(const std::shared_ptr<TpInstance::TProblemData>& idatsptr, un
         case 4:
             reduced_cost_fptr = &TSimplex::computeReducedCostsPol_4;
             break;
+        case 5:
+            reduced_cost_fptr = &TSimplex::computeReducedCostsPol_5;
+            break;
         default:
             throw std::runtime_error("Unknown r.c. computation method");
     }
@@ -218,6 +239,55 @@ void TSimplex::setVerbose()
     verbose_log = true;
 }
 
+void TSimplex::setThreads(unsigned int thrds)
+{
+    algcfg.threads = thrds > 0 ? thrds : 1;
+}
+
+void TSimplex::setWarmStart(bool flag)
+{
+    warm_start = flag;
+}
+
+void TSimplex::setCancelFlag(const std::atomic<bool>* flag)
+{
+    cancel_flag = flag;
+}
+
+void TSimplex::setProgressCallback(const progress_callback& cb, unsigned long every_iters)
+{
+    progress_cb = cb;
+    progress_every = every_iters > 0 ? every_iters : 1;
+}
+
+void TSimplex::setInstrumentation(bool flag)
+{
+    instr_on = flag;
+}
+
+void TSimplex::setTraceFile(const std::string& fname)
+{
+    trace_fname = fname;
+}
+
+bool TSimplex::stopRequested()
+{
+    if((cancel_flag != nullptr && cancel_flag->load(std::memory_order_relaxed)) || std::chrono::steady_clock::now() > deadline)
+        scan_stopped = true;
+    
+    return scan_stopped;
+}
+
+void TSimplex::setAlgData(const std::shared_ptr<tplex_alg_data>& tplxd_sptr)
+{
+    optdata_sptr = tplxd_sptr;
+}
+
+const std::shared_ptr<tplex_alg_data>& TSimplex::getAlgData()
+{
+    return optdata_sptr;
+}
+
 #ifdef EXPTRACING_2
 void TSimplex::dump_tracing_data_to_file(std::string tag, std::string iname)
 {
@@ -306,7 +376,8 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
                           << " (" << (algcfg.window_size_factor * (tpdata_sptr->m + tpdata_sptr->n)) << " variables)"
                           << "\n\t\t\tW2 = " << algcfg.window_size_2_factor 
                           << " (" << (algcfg.window_size_2_factor * (tpdata_sptr->m + tpdata_sptr->n)) << " variables)"
-                          << "\n\t\t\tpartition size factor = " << algcfg.partition_factor;
+                          << "\n\t\t\tpartition size factor = " << algcfg.partition_factor
+                          << "\n\t\t\tthreads = " << algcfg.threads;
         FILE_LOG(logINFO) << "T. Simplex algorithm"
                           << " ::: program eps >> " << std::setprecision(10) << MYEPS 
                           << " ::: problem eps quantity >> " << std::setprecision(10) << EPSQ;
@@ -337,7 +408,41 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
     FILE_LOG(logINFO) << "Init data structure ...";
     auto st_0 = std::chrono::steady_clock::now();
     clock_t startt = clock();
-    tplexd_sptr.reset(new tplex_alg_data(tpdata_sptr, true));
+    deadline = std::isnan(tlim)
+               ? (std::chrono::steady_clock::time_point::max)()
+               : st_0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(tlim));
+    /// reuse data buffers of a previous solve of the same size
+    std::shared_ptr<SpanningTree> warmspat_sptr(nullptr);
+    /// capacitated problems: single pivots of bounded vars from the capacitated rule, no warm start
+    bool capacitated = !tpdata_sptr->capacities.empty();
+    if(capacitated)
+    {
+        FILE_LOG(logINFO) << "Capacitated problem ::: capacitated lanes >> " << tpdata_sptr->capacities.size()
+                          << (algcfg.multipiv ? " ::: single pivots" : "") << (algcfg.rccpol == 4 ? " ::: r.c. rule 3" : "")
+                          << (resume_opt || warm_start ? " ::: cold start" : "");
+        algcfg.multipiv = false;
+        if(algcfg.rccpol == 4)
+        {
+            algcfg.rccpol = 3;
+            reduced_cost_fptr = &TSimplex::computeReducedCostsPol_3;
+        }
+    }
+    bool resume = !capacitated && resume_opt && optdata_sptr != nullptr && optdata_sptr->vdata.spat_sptr != nullptr;
+    resume_opt = false;
+    if(resume)
+    {   /// resume from the basis and the var data of the last solve, see updateCosts(..)
+        tplexd_sptr = optdata_sptr;
+        warmspat_sptr = tplexd_sptr->vdata.spat_sptr;
+    }
+    else if(optdata_sptr != nullptr && optdata_sptr->rows.size() == tpdata_sptr->m && optdata_sptr->cols.size() == tpdata_sptr->n)
+    {
+        tplexd_sptr = optdata_sptr;
+        if(warm_start && !capacitated)
+            warmspat_sptr = tplexd_sptr->vdata.spat_sptr;
+        tplexd_sptr->reset();
+    }
+    else
+        tplexd_sptr.reset(new tplex_alg_data(tpdata_sptr, true));
     /// initialize opt data
     if(algcfg.rccpol == 3 || (algcfg.init_sol_method > 1 && algcfg.init_sol_method < 9))
     {
@@ -345,11 +450,37 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
         cmp_times[1] += GETOPTTMS(st_0);
         FILE_LOG(logINFO)  << "Data structure initialization time >> " << cmp_times[1] << " [ms] ::: problem vars " << (algcfg.partition_factor < MYEPS ? "*sorted*" : "*partitioned*");
     }
+    /// row suffix min. costs for dual-bound pruning of full scans
+    if(algcfg.rccpol == 0 || algcfg.rccpol == 1)
+    {
+        auto st_0_0 = std::chrono::steady_clock::now();
+        this->initRowMinCosts(tplexd_sptr->vdata);
+        double rmctm = GETOPTTMS(st_0_0);
+        cmp_times[1] += rmctm;
+        FILE_LOG(logINFO)  << "Row suffix min. costs time >> " << rmctm << " [ms]";
+    }
+    /// cost-sorted rows
+    if(algcfg.rccpol == 5)
+    {
+        auto st_0_0 = std::chrono::steady_clock::now();
+        this->initRowSortedCosts(tplexd_sptr->vdata);
+        double rsctm = GETOPTTMS(st_0_0);
+        cmp_times[1] += rsctm;
+        FILE_LOG(logINFO)  << "Row sorting time >> " << rsctm << " [ms]";
+    }
     
     /// compute initial solution
     auto st_0_1 = std::chrono::steady_clock::now();
     optresult optres;
-    if(algcfg.init_sol_method == 1)
+    if(warmspat_sptr != nullptr && (optres = this->basis_solution(tplexd_sptr, warmspat_sptr)).integer_values[0] > 0)
+    {   /// basis of the previous solve
+        basisspat_sptr = warmspat_sptr;
+    }
+    else if(capacitated)
+    {   /// MMR within the capacities
+        optres = this->capacitated_rule(tplexd_sptr);
+    }
+    else if(algcfg.init_sol_method == 1)
     {   /// north-west corner
         optres = this->nwcorner(tplexd_sptr);
     }
@@ -357,6 +488,14 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
     {   /// MMR
         optres = this->matrix_min_rule(tplexd_sptr);
     }
+    else if(algcfg.init_sol_method == 3)
+    {   /// multiscale
+        optres = this->multiscale_rule(tplexd_sptr);
+    }
+    else if(algcfg.init_sol_method == 4)
+    {   /// Sinkhorn
+        optres = this->sinkhorn_rule(tplexd_sptr);
+    }
     else
     {   /// throw exception if no method is recognized
         throw std::invalid_argument("Unknow method for the initial basis computation");
@@ -387,6 +526,9 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
     }
     /// set spanning tree as p. data
     tplexd_sptr->vdata.spat_sptr = basisspat_sptr;
+    /// position handles of the basis by rows and cols, kept by the pivots
+    if(UPDRWCLSOL)
+        tplexd_sptr->indexRowsCols();
     
     /// tracing data (experiments and development stuff)
     #ifdef EXPTRACING_2
@@ -421,9 +563,18 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
     varredcsts.reserve(tpdata_sptr->m + tpdata_sptr->n);
     objf_improvs.resize(impr_vec_size, std::numeric_limits<double>::quiet_NaN());
     ml_exit_code = allrcscmp_count = succes_lpsrch_count = failed_lpsrch_count = saved_lpsrch_count = tempt_var_count = computed_neighs = 0;
+    pruned_rcs = 0;
     tot_bchng = bchng = alg_super_iter = alg_iter = 0;
     iter_objfv = objf_value = optres.obj_value;
     tot_q = optres.double_values[0];
+    instr = instr_on ? &Instr::local() : nullptr;
+    if(instr != nullptr)
+        instr->reset();
+    std::unique_ptr<TraceWriter> trace_wr(trace_fname.empty() ? nullptr : new TraceWriter(trace_fname));
+    iter_record trace_rec;
+    double itmltm;
+    double itrctm;
+    double itpvtm;
     
     /// main loop
     if(!retheur)
@@ -436,17 +587,32 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
             nd = basisspat_sptr->getPredecessor(entering_vars[0].i) == entering_vars[0].j + tpdata_sptr->m
                  ? entering_vars[0].j + tpdata_sptr->m
                  : entering_vars[0].i;
-        basisspat_sptr->computeTSpxMultips(tpdata_sptr->costs, tplexd_sptr->us, tplexd_sptr->vs, nd);
+        {
+            Instr::scoped_timer itm(instr, Instr::MULTIPLIERS);
+            basisspat_sptr->computeTSpxMultips(tpdata_sptr->costs, tplexd_sptr->us, tplexd_sptr->vs, nd);
+        }
         
         /// get time
-        cmp_times[3] += GETOPTTMS(st_3);
+        cmp_times[3] += (itmltm = GETOPTTMS(st_3));
 
         /// start chrono
         auto st_4 = std::chrono::steady_clock::now();
         
         /// Compute reduced costs    
         entering_vars.clear();
+        scan_stopped = false;
+        scan_cells = 0;
+        auto st_i = Instr::tick(instr, Instr::PRICING);
         rccmprv = (this->*reduced_cost_fptr)(tplexd_sptr->quantities, tplexd_sptr->us, tplexd_sptr->vs, tplexd_sptr->vdata, varredcsts, entering_vars);
+        if(!tplexd_sptr->vdata.upper.empty())
+            this->priceUpperVars(tplexd_sptr->us, tplexd_sptr->vs, tplexd_sptr->vdata, entering_vars);
+        if(instr != nullptr)
+        {
+            Instr::tock(instr, Instr::PRICING, st_i);
+            instr->counters[Instr::ITERATIONS]++;
+            instr->counters[Instr::PRICED_CELLS] += scan_cells;
+            instr->hists[Instr::PRICED_CELLS_PER_ITER].add(scan_cells);
+        }
         
         /// update some counters
         if(rccmprv.first || algcfg.rccpol == 4)
@@ -461,9 +627,13 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
         }
         
         /// get time
-        cmp_times[4] += GETOPTTMS(st_4);
+        cmp_times[4] += (itrctm = GETOPTTMS(st_4));
         
         /// Pivoting phase
+        itpvtm = 0.0;
+        deg_pivots = 0;
+        if(trace_wr != nullptr)
+            trace_rec.entering = entering_vars.size();
         if(!entering_vars.empty())
         {
             /// TRACING CODE
@@ -474,15 +644,21 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
             /// start chrono
             auto st_5 = std::chrono::steady_clock::now();
             /// pivoting
-            pivotrv = this->pivoting(tplexd_sptr, basisspat_sptr, entering_vars, objf_value, tot_q /*, !USESPAT4ALL */ );
+            pivotrv = this->pivoting(tplexd_sptr, basisspat_sptr, entering_vars, objf_value, tot_q, UPDRWCLSOL);
             
             /// get time
-            cmp_times[5] += GETOPTTMS(st_5);
+            cmp_times[5] += (itpvtm = GETOPTTMS(st_5));
             cmp_times[6] += std::get<4>(pivotrv);
             cmp_times[7] += std::get<5>(pivotrv);
             /// get other stat. values
             bchng += std::get<0>(pivotrv);
             tot_bchng += std::get<0>(pivotrv);
+            if(instr != nullptr)
+            {
+                instr->counters[Instr::PIVOTS] += std::get<0>(pivotrv);
+                instr->counters[Instr::DEGENERATE_PIVOTS] += deg_pivots;
+                instr->hists[Instr::PIVOTS_PER_ITER].add(std::get<0>(pivotrv));
+            }
             
             /// TRACING CODE
             #ifdef EXPTRACING_2
@@ -498,6 +674,21 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
         /// update iters
         ++alg_iter;
         
+        /// trace record, the obj. f. of the tree is O(m + n)
+        if(trace_wr != nullptr)
+        {
+            trace_rec.iter = alg_iter;
+            trace_rec.priced_cells = scan_cells;
+            trace_rec.pivots = entering_vars.empty() ? 0 : std::get<0>(pivotrv);
+            trace_rec.degenerate = deg_pivots;
+            trace_rec.objf_value = this->solutionObjF(tplexd_sptr, basisspat_sptr).first;
+            trace_rec.elapsed = GETOPTTMS(st_2);
+            trace_rec.multips_time = itmltm;
+            trace_rec.pricing_time = itrctm;
+            trace_rec.pivoting_time = itpvtm;
+            trace_wr->push(trace_rec);
+        }
+        
         /// logging
         if(verbose_log && rccmprv.first) //&& (bchng ? bchng - deg_bchng_ctr : 0) > 0)
         {
@@ -531,15 +722,32 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
                      opt_sec);
         }
         
-        /// Optimal solution
-        if(entering_vars.empty())
+        /// Optimal solution, unless the pricing scan was stopped
+        if(entering_vars.empty() && !scan_stopped)
             ml_exit_code = 1;
         /// Time limit
-        if(!std::isnan(tlim) && (tlim + MYEPS < opt_sec))
+        if(!std::isnan(tlim) && (tlim + MYEPS < opt_sec || scan_stopped))
             ml_exit_code = 2;
         /// max iter
         if(alg_iter >= algcfg.max_macroiter)
             ml_exit_code = 3;
+        /// cancelled, e.g., another racer found the optimum
+        if(cancel_flag != nullptr && cancel_flag->load(std::memory_order_relaxed))
+            ml_exit_code = 4;
+        /// progress report, the callback can stop the optimization
+        if(progress_cb && !ml_exit_code && alg_iter % progress_every == 0)
+        {
+            progress_info pinfo;
+            pinfo.iter = alg_iter;
+            pinfo.super_iter = alg_super_iter;
+            pinfo.basis_changes = tot_bchng;
+            /// obj. f. of the current basis, O(m + n)
+            pinfo.objf_value = this->solutionObjF(tplexd_sptr, basisspat_sptr).first;
+            pinfo.elapsed_sec = GETOPTTMS(st_0) / 1000.0;
+            pinfo.pivot_rate = pinfo.elapsed_sec > 0.0 ? tot_bchng / pinfo.elapsed_sec : 0.0;
+            if(!progress_cb(pinfo))
+                ml_exit_code = 4;
+        }
         
         if(!algcfg.multipiv || rccmprv.first)
             bchng = 0;
@@ -553,13 +761,20 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
         #endif
     }
     while(!ml_exit_code);
+    if(trace_wr != nullptr)
+        trace_wr->close();
     /// log
     if(verbose_log) { LOGCLEAR(); }
-    FILE_LOG(logINFO) << (ml_exit_code == 1 ? "Optimal solution found" : "Limit reached");
+    FILE_LOG(logINFO) << (ml_exit_code == 1 ? "Optimal solution found" : ml_exit_code == 4 ? "Cancelled" : "Limit reached");
+    if(instr != nullptr)
+    {
+        FILE_LOG(logINFO) << Instr::report(*instr);
+        instr = nullptr;
+    }
     
     /// Compute obj f
     auto objftm = std::chrono::steady_clock::now();
-    auto objf_and_tsq = basisspat_sptr->computeTSpxObjF(tpdata_sptr->costs, tplexd_sptr->quantities);
+    auto objf_and_tsq = this->solutionObjF(tplexd_sptr, basisspat_sptr);
     objf_value = objf_and_tsq.first;
     tot_q = objf_and_tsq.second;
     double objf_tm = GETOPTTMS(objftm);
@@ -577,6 +792,12 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
     optres.run_time = opt_sec;
     optres.tags.resize(3);
     optres.tags[2] = ml_exit_code == 1 ? "Optimal" : "NotOptimal";
+    /// sparse instances: an optimal solution shipping on big M lanes costs more than any solution on the arcs
+    if(ml_exit_code == 1 && tpdata_sptr->costs.isSparse() && objf_value > std::max(0.0, tpdata_sptr->maxc) * tot_q + 0.5)
+    {
+        FILE_LOG(logWARNING) << "Sparse instance ::: optimal solution on lanes without arcs ::: infeasible";
+        optres.tags[2] = "Infeasible";
+    }
     optres.integer_values.resize(2, 0);
     optres.integer_values.push_back(alg_super_iter);
     optres.integer_values.push_back(alg_iter);
@@ -643,6 +864,7 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
         ORTABLINE(logINFO, optreptab, "simplex", "iterations", alg_iter, "");
         ORTABLINE(logINFO, optreptab, "simplex", "basis changes", tot_bchng, "");
         ORTABLINE(logINFO, optreptab, "simplex", "full rc comp", allrcscmp_count, "");
+        ORTABLINE(logINFO, optreptab, "simplex", "pruned r costs", pruned_rcs, "");
         ORTABLINE(logINFO, optreptab, "simplex", "opt time", cmp_times[2], " [ms]");
         ORTABLINE(logINFO, optreptab, "simplex", "opt time (1)", cmp_times[9], " [ms]");
         ORTABLINE(logINFO, optreptab, "simplex", "mulipliers time", cmp_times[3], " [ms]");
@@ -697,6 +919,78 @@ optresult TSimplex::tsimplex(double tlim, bool alginfolog, bool reptab)
     return optres;
 }
 
+optresult TSimplex::updateCosts(const std::vector<cost_change>& changes, double tlim, bool alginfolog, bool reptab)
+{
+    if(optdata_sptr == nullptr || optdata_sptr->vdata.spat_sptr == nullptr)
+        throw std::runtime_error("No basis to re-optimize, run tsimplex(..) first");
+    
+    FILE_LOG(logINFO) << "Update costs ::: changed costs >> " << changes.size();
+    auto st_0 = std::chrono::steady_clock::now();
+    
+    /// new costs, the cost stats and the pvars follow them, the stats are recomputed only if a min. or max. cost changed
+    bool stats = false;
+    double cf = 1.0 / tpdata_sptr->costs.vars();
+    bool pvars = tpdata_sptr->pvars.size() == tpdata_sptr->costs.vars();
+    for(auto it = changes.begin(); it != changes.end(); it++)
+    {
+        if(std::get<0>(*it) >= tpdata_sptr->m || std::get<1>(*it) >= tpdata_sptr->n)
+            throw std::out_of_range("No variable (" + std::to_string(std::get<0>(*it)) + "," + std::to_string(std::get<1>(*it)) + ")");
+        NodeArcIdType v = tpdata_sptr->n * std::get<0>(*it) + std::get<1>(*it);
+        double c = std::get<2>(*it);
+        double oldc = tpdata_sptr->costs[v];
+        tpdata_sptr->costs.set(v, c);
+        stats = stats || (oldc == tpdata_sptr->minc && c > oldc) || (oldc == tpdata_sptr->maxc && c < oldc);
+        tpdata_sptr->minc = std::min(tpdata_sptr->minc, c);
+        tpdata_sptr->maxc = std::max(tpdata_sptr->maxc, c);
+        tpdata_sptr->avgc += (c - oldc) * cf;
+        if(pvars)
+            tpdata_sptr->pvars[this->varIndex(std::get<0>(*it), std::get<1>(*it))].second = c;
+    }
+    if(stats)
+        tpdata_sptr->computeCostStats();
+    
+    /// re-price the changed vars only, the basis stays primal feasible
+    this->updateVarData(optdata_sptr->vdata, changes);
+    FILE_LOG(logINFO) << "Var data update time >> " << GETOPTTMS(st_0) << " [ms]";
+    
+    resume_opt = true;
+    return this->tsimplex(tlim, alginfolog, reptab);
+}
+
+optresult TSimplex::updateQuantities(const std::vector<TpQuantityType>& sources, const std::vector<TpQuantityType>& destinations,
+                                      double tlim, bool alginfolog, bool reptab)
+{
+    if(optdata_sptr == nullptr || optdata_sptr->vdata.spat_sptr == nullptr)
+        throw std::runtime_error("No basis to re-optimize, run tsimplex(..) first");
+    
+    /// the slack node of an unbalanced problem follows the new totals, see TProblemData::balance()
+    TpCostMatrix::Slack side = tpdata_sptr->costs.slackSide();
+    NodeArcIdType M = tpdata_sptr->m - (side == TpCostMatrix::Slack::Source ? 1 : 0);
+    NodeArcIdType N = tpdata_sptr->n - (side == TpCostMatrix::Slack::Destination ? 1 : 0);
+    if(sources.size() != M || destinations.size() != N)
+        throw std::invalid_argument("Wrong number of supplies or demands");
+    
+    std::copy(sources.begin(), sources.end(), tpdata_sptr->sources.begin());
+    std::copy(destinations.begin(), destinations.end(), tpdata_sptr->destinations.begin());
+    M = tpdata_sptr->m;
+    N = tpdata_sptr->n;
+    tpdata_sptr->balance();
+    
+    FILE_LOG(logINFO) << "Update quantities ::: total quantity >> " << std::fixed << std::setprecision(0) << tpdata_sptr->tot_src_quantity;
+    
+    /// the slack node changed side, appeared or disappeared: the basis and the var data of the last solve do not fit
+    if(tpdata_sptr->m != M || tpdata_sptr->n != N)
+    {
+        FILE_LOG(logINFO) << "Update quantities ::: slack node changed ::: solve from scratch";
+        resume_opt = false;
+        return this->tsimplex(tlim, alginfolog, reptab);
+    }
+    
+    /// costs are unchanged: the basis stays dual feasible and the var data are still valid
+    resume_opt = true;
+    return this->tsimplex(tlim, alginfolog, reptab);
+}
+
 std::string tplex_alg_data::toStringSol()
 {
     NodeArcIdType M = us.size();
@@ -718,18 +1012,24 @@ std::string tplex_alg_data::toStringSol()
 
 void TSimplex::initVarData(tplex_alg_data::var_data& vdata)
 {
-    NodeArcIdType M = tpdata_sptr->m;
     NodeArcIdType N = tpdata_sptr->n;
-    NodeArcIdType VCT = M * N;
+    NodeArcIdType VCT;
     
     /// if 1st call init. data
     if(vdata.cs.empty())
     {
+        /// in-memory instances build pvars lazily
+        tpdata_sptr->initPVars();
+        /// lanes, the arcs only of sparse instances
+        VCT = tpdata_sptr->pvars.size();
+        
         /// sort data
         if(algcfg.partition_factor < MYEPS)
         {
             auto st_5 = std::chrono::steady_clock::now();
-            std::sort(tpdata_sptr->pvars.begin(), tpdata_sptr->pvars.end(), 
+            /// sort a copy, problem data are read-only and may be shared by several solvers
+            std::vector<std::pair<NodeArcIdType, double>> svars(tpdata_sptr->pvars);
+            std::sort(svars.begin(), svars.end(), 
                       [](const std::pair<NodeArcIdType, double>& a, const std::pair<NodeArcIdType, double>& b)
                       {
                           return a.second < b.second;
@@ -743,12 +1043,13 @@ void TSimplex::initVarData(tplex_alg_data::var_data& vdata)
             vdata.is.resize(VCT);
             vdata.js.resize(VCT);
             
-            for(NodeArcIdType c = 0; c < tpdata_sptr->pvars.size(); c++)
+            for(NodeArcIdType c = 0; c < svars.size(); c++)
             {
-                vdata.cs[c] = tpdata_sptr->pvars[c].second;
-                vdata.is[c] = tpdata_sptr->pvars[c].first / N;
-                vdata.js[c] = tpdata_sptr->pvars[c].first % N;
+                vdata.cs[c] = svars[c].second;
+                vdata.is[c] = svars[c].first / N;
+                vdata.js[c] = svars[c].first % N;
             }
+            vdata.sorted_upto = VCT;
             FILE_LOG(logINFO) << "Data struct time >> " << GETOPTTMS(st_5) << " [ms]"; 
         }
         else
@@ -757,7 +1058,7 @@ void TSimplex::initVarData(tplex_alg_data::var_data& vdata)
             
             /// Lazy clustering strategy
             #ifdef LAZYCLUST
-            NodeArcIdType LC = (tpdata_sptr->m * tpdata_sptr->n) / (algcfg.partition_factor * (tpdata_sptr->m + tpdata_sptr->n));
+            NodeArcIdType LC = VCT / (algcfg.partition_factor * (tpdata_sptr->m + tpdata_sptr->n));
             double ct = (std::min(1.0, tpdata_sptr->minc) + tpdata_sptr->maxc - tpdata_sptr->minc) / (LC - 1) + tpdata_sptr->minc + std::min(1.0, tpdata_sptr->minc);
             FILE_LOG(logINFO) << "**Lazy clustering** ::: cost threshold >> " << ct; 
             std::unique_ptr<std::vector<std::vector<std::pair<NodeArcIdType, double>>>> cost_partitons(new std::vector<std::vector<std::pair<NodeArcIdType, double>>>(2));
@@ -779,7 +1080,7 @@ void TSimplex::initVarData(tplex_alg_data::var_data& vdata)
             FILE_LOG(logINFO) << "Cluster 0 sorting time >> " << GETOPTTMS(st_srt) << " [ms]"; 
             #else
             /// Initial clustering
-            NodeArcIdType LC = (tpdata_sptr->m * tpdata_sptr->n) / (algcfg.partition_factor * (tpdata_sptr->m + tpdata_sptr->n));
+            NodeArcIdType LC = VCT / (algcfg.partition_factor * (tpdata_sptr->m + tpdata_sptr->n));
             std::unique_ptr<std::vector<std::vector<std::pair<NodeArcIdType, double>>>> cost_partitons(new std::vector<std::vector<std::pair<NodeArcIdType, double>>>(LC));
             
             for(NodeArcIdType v = 0; v < tpdata_sptr->pvars.size(); v++)
@@ -805,11 +1106,206 @@ void TSimplex::initVarData(tplex_alg_data::var_data& vdata)
                     ++c;
                 }
             }
+            /// cluster 0 is sorted and cluster 1 costs are not lower than its costs
+            #ifdef LAZYCLUST
+            vdata.sorted_upto = (*cost_partitons)[0].size();
+            #else
+            vdata.sorted_upto = 0;
+            #endif
             FILE_LOG(logINFO) << "Data struct time >> " << GETOPTTMS(st_5) << " [ms]"; 
         }
     }
 }
 
+void TSimplex::initRowMinCosts(tplex_alg_data::var_data& vdata)
+{
+    NodeArcIdType M = tpdata_sptr->m;
+    
+    /// if 1st call init. data
+    if(vdata.row_sufbeg.size() == M + 1)
+        return;
+    
+    /// a row without stored costs keeps a block for its slack lanes
+    vdata.row_sufbeg.resize(M + 1);
+    vdata.row_sufbeg[0] = 0;
+    for(NodeArcIdType i = 0; i < M; i++)
+        vdata.row_sufbeg[i + 1] = vdata.row_sufbeg[i] + std::max<std::size_t>(1, (this->rowArcBegin(i + 1) - this->rowArcBegin(i) + ROWSUFBLK - 1) / ROWSUFBLK);
+    vdata.row_sufminc.resize(vdata.row_sufbeg[M]);
+    for(NodeArcIdType i = 0; i < M; i++)
+        this->rowSuffixMinCosts(vdata, i);
+}
+
+void TSimplex::rowSuffixMinCosts(tplex_alg_data::var_data& vdata, NodeArcIdType i) const
+{
+    const TpInstance::tcosts& costs = tpdata_sptr->costs;
+    std::size_t abeg = this->rowArcBegin(i);
+    std::size_t aend = this->rowArcBegin(i + 1);
+    double minc = std::numeric_limits<double>::max();
+    for(std::size_t s = costs.slackRowBegin(i); s < costs.slackRowBegin(i + 1); s++)
+        minc = std::min(minc, costs.slackCosts()[s]);
+    for(std::size_t b = vdata.row_sufbeg[i + 1]; b > vdata.row_sufbeg[i]; )
+    {
+        --b;
+        std::size_t a = abeg + (b - vdata.row_sufbeg[i]) * ROWSUFBLK;
+        std::size_t e = std::min(aend, a + ROWSUFBLK);
+        for( ; a < e; a++)
+            minc = std::min(minc, costs.begin()[a]);
+        vdata.row_sufminc[b] = minc;
+    }
+}
+
+void TSimplex::initRowSortedCosts(tplex_alg_data::var_data& vdata)
+{
+    NodeArcIdType M = tpdata_sptr->m;
+    
+    /// if 1st call init. data
+    if(vdata.row_cs.size() == tpdata_sptr->costs.vars())
+        return;
+    
+    vdata.row_cs.resize(tpdata_sptr->costs.vars());
+    vdata.row_js.resize(tpdata_sptr->costs.vars());
+    for(NodeArcIdType i = 0; i < M; i++)
+        this->sortRowCosts(vdata, i);
+}
+
+void TSimplex::sortRowCosts(tplex_alg_data::var_data& vdata, NodeArcIdType i)
+{
+    const TpInstance::tcosts& costs = tpdata_sptr->costs;
+    std::size_t beg = this->rowArcBegin(i);
+    std::size_t end = this->rowArcBegin(i + 1);
+    std::size_t sbeg = costs.slackRowBegin(i);
+    std::size_t send = costs.slackRowBegin(i + 1);
+    std::vector<std::pair<double, NodeArcIdType>> row;
+    row.reserve(end - beg + send - sbeg);
+    for(std::size_t a = beg; a < end; a++)
+        row.push_back(std::make_pair(costs.begin()[a], this->arcDestination(i, a)));
+    for(std::size_t s = sbeg; s < send; s++)
+        row.push_back(std::make_pair(costs.slackCosts()[s], costs.slackDestination(s)));
+    std::sort(row.begin(), row.end());
+    std::size_t vbeg = this->rowVarBegin(i);
+    for(std::size_t k = 0; k < row.size(); k++)
+    {
+        vdata.row_cs[vbeg + k] = row[k].first;
+        vdata.row_js[vbeg + k] = row[k].second;
+    }
+}
+
+void TSimplex::updateVarData(tplex_alg_data::var_data& vdata, const std::vector<cost_change>& changes)
+{
+    NodeArcIdType N = tpdata_sptr->n;
+    std::vector<std::pair<std::size_t, NodeArcIdType>> vars;
+    std::vector<NodeArcIdType> rows;
+    
+    /// changed vars, by var index, and changed rows, once each
+    vars.reserve(changes.size());
+    for(auto it = changes.begin(); it != changes.end(); it++)
+    {
+        std::ptrdiff_t v = this->varIndex(std::get<0>(*it), std::get<1>(*it));
+        if(v >= 0)
+            vars.push_back(std::make_pair(std::size_t(v), std::get<0>(*it)));
+    }
+    std::sort(vars.begin(), vars.end());
+    vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+    rows.reserve(vars.size());
+    for(auto it = vars.begin(); it != vars.end(); it++)
+        rows.push_back(it->second);
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    
+    /// sorted or partitioned vars: a changed var moves to its place in the sorted prefix, leaves the prefix if it costs
+    /// more than the prefix max. and joins it from the tail if it does not, the vars in between shift by one
+    if(!vdata.cs.empty())
+    {
+        NodeArcIdType VCT = vdata.cs.size();
+        bool full_sort = vdata.sorted_upto == VCT;
+        NodeArcIdType& P = vdata.sorted_upto;
+        if(vdata.cs_pos.size() != VCT)
+        {
+            vdata.cs_pos.resize(VCT);
+            for(NodeArcIdType u = 0; u < VCT; u++)
+                vdata.cs_pos[this->varIndex(vdata.is[u], vdata.js[u])] = u;
+        }
+        auto move = [&](NodeArcIdType from, NodeArcIdType to)
+        {
+            double c = vdata.cs[from];
+            NodeArcIdType i = vdata.is[from];
+            NodeArcIdType j = vdata.js[from];
+            for( ; from > to; from--)
+            {
+                vdata.cs[from] = vdata.cs[from - 1], vdata.is[from] = vdata.is[from - 1], vdata.js[from] = vdata.js[from - 1];
+                vdata.cs_pos[this->varIndex(vdata.is[from], vdata.js[from])] = from;
+            }
+            for( ; from < to; from++)
+            {
+                vdata.cs[from] = vdata.cs[from + 1], vdata.is[from] = vdata.is[from + 1], vdata.js[from] = vdata.js[from + 1];
+                vdata.cs_pos[this->varIndex(vdata.is[from], vdata.js[from])] = from;
+            }
+            vdata.cs[to] = c, vdata.is[to] = i, vdata.js[to] = j;
+            vdata.cs_pos[this->varIndex(i, j)] = to;
+        };
+        
+        for(auto it = vars.begin(); it != vars.end(); it++)
+        {
+            NodeArcIdType u = vdata.cs_pos[it->first];
+            double c = tpdata_sptr->costs[N * vdata.is[u] + vdata.js[u]];
+            if(!full_sort && u >= P)
+            {
+                /// tail var: swapped with the first tail var into the prefix if it does not cost more than the prefix max.
+                if(P == 0 || c > vdata.cs[P - 1])
+                {
+                    vdata.cs[u] = c;
+                    continue;
+                }
+                std::swap(vdata.cs[u], vdata.cs[P]), std::swap(vdata.is[u], vdata.is[P]), std::swap(vdata.js[u], vdata.js[P]);
+                vdata.cs_pos[this->varIndex(vdata.is[u], vdata.js[u])] = u;
+                vdata.cs_pos[it->first] = P;
+                u = P++;
+            }
+            else if(!full_sort && c > (u + 1 < P ? vdata.cs[P - 1] : P > 1 ? vdata.cs[P - 2] : std::numeric_limits<double>::lowest()))
+            {
+                /// prefix var costing more than the others: the last prefix var, then the first tail var
+                move(u, P - 1);
+                vdata.cs[--P] = c;
+                continue;
+            }
+            NodeArcIdType end = full_sort ? VCT : P;
+            NodeArcIdType t = u;
+            if(u > 0 && c < vdata.cs[u - 1])
+                t = std::upper_bound(vdata.cs.begin(), vdata.cs.begin() + u, c) - vdata.cs.begin();
+            else if(u + 1 < end && c > vdata.cs[u + 1])
+                t = std::lower_bound(vdata.cs.begin() + u + 1, vdata.cs.begin() + end, c) - vdata.cs.begin() - 1;
+            vdata.cs[u] = c;
+            move(u, t);
+        }
+    }
+    
+    /// row suffix min. costs and cost-sorted rows of the changed rows
+    for(auto it = rows.begin(); it != rows.end(); it++)
+    {
+        if(vdata.row_sufbeg.size() == tpdata_sptr->m + 1)
+            this->rowSuffixMinCosts(vdata, *it);
+        if(vdata.row_cs.size() == tpdata_sptr->costs.vars())
+            this->sortRowCosts(vdata, *it);
+    }
+}
+
+std::ptrdiff_t TSimplex::varIndex(NodeArcIdType i, NodeArcIdType j) const
+{
+    const TpInstance::tcosts& costs = tpdata_sptr->costs;
+    if(costs.isDirect())
+        return std::ptrdiff_t(tpdata_sptr->n) * i + j;
+    
+    std::size_t abeg = this->rowArcBegin(i);
+    std::size_t vbeg = this->rowVarBegin(i) + this->rowArcBegin(i + 1) - abeg;
+    /// slack lanes after the stored ones: the slack destination in each row, the slack source row
+    if(costs.slackSide() == TpCostMatrix::Slack::Destination && j + 1 == tpdata_sptr->n)
+        return vbeg;
+    if(costs.slackSide() == TpCostMatrix::Slack::Source && i + 1 == tpdata_sptr->m)
+        return vbeg + j;
+    std::ptrdiff_t a = costs.isSparse() ? costs.arc(i, j) : std::ptrdiff_t(abeg + j);
+    return a < 0 ? -1 : std::ptrdiff_t(this->rowVarBegin(i) + a - abeg);
+}
+
 NodeArcIdType
 TSimplex::compute_shields_v2(const TpInstance::tcosts& costs,
                              bool redp,
@@ -841,7 +1337,8 @@ TSimplex::compute_shields_v2(const TpInstance::tcosts& costs,
         {
             /// Step 1
             t = supp[i][j];
-            if(redp && !tpdata_sptr->destinations_map_bw[t])
+            /// the slack destination is not on the grid
+            if(t >= dest || (redp && !tpdata_sptr->destinations_map_bw[t]))
                 continue;
         
             if(!(*N_sptr)[i][t])
@@ -849,7 +1346,7 @@ TSimplex::compute_shields_v2(const TpInstance::tcosts& costs,
                 (*N_sptr)[i][t] = true;
                 varredcsts.push_back(redp ? CellVar(tpdata_sptr->sources_map_bw[i] - 1, tpdata_sptr->destinations_map_bw[t] - 1, 
                                                                     costs[(tpdata_sptr->sources_map_bw[i] - 1) * tpdata_sptr->n + (tpdata_sptr->destinations_map_bw[t] - 1)], 0.0)
-                                          : CellVar(i, t, costs[i * dest + t], 0.0));
+                                          : CellVar(i, t, costs[i * tpdata_sptr->n + t], 0.0));
                 ++neigh_size;
             }
             /// Step 2
@@ -861,7 +1358,7 @@ TSimplex::compute_shields_v2(const TpInstance::tcosts& costs,
                     (*N_sptr)[board.cell[i].neigh[h]][t] = true;
                     varredcsts.push_back(redp ? CellVar(tpdata_sptr->sources_map_bw[board.cell[i].neigh[h]] - 1, tpdata_sptr->destinations_map_bw[t] - 1, 
                                                                         costs[(tpdata_sptr->sources_map_bw[board.cell[i].neigh[h]] - 1) * tpdata_sptr->n + (tpdata_sptr->destinations_map_bw[t] - 1)], 0.0)
-                                              :  CellVar(board.cell[i].neigh[h], t,  costs[board.cell[i].neigh[h] * dest + t], 0.0));
+                                              :  CellVar(board.cell[i].neigh[h], t,  costs[board.cell[i].neigh[h] * tpdata_sptr->n + t], 0.0));
                     ++neigh_size;
                 }
             }
@@ -879,7 +1376,7 @@ TSimplex::compute_shields_v2(const TpInstance::tcosts& costs,
                     (*N_sptr)[i][t] = true;
                     varredcsts.push_back(redp ? CellVar(tpdata_sptr->sources_map_bw[i] - 1, tpdata_sptr->destinations_map_bw[t] - 1, 
                                                                         costs[(tpdata_sptr->sources_map_bw[i] - 1) * tpdata_sptr->n + (tpdata_sptr->destinations_map_bw[t] - 1)], 0.0)
-                                              : CellVar(i, t, costs[i * dest + t], 0.0));
+                                              : CellVar(i, t, costs[i * tpdata_sptr->n + t], 0.0));
                     ++neigh_size;
                 }
             }
@@ -889,6 +1386,97 @@ TSimplex::compute_shields_v2(const TpInstance::tcosts& costs,
     return neigh_size;
 }
 
+template<bool BOUNDED>
+std::pair<bool,bool>
+TSimplex::reducedCostsPol_5(const ts_sol& quantities,
+                            const std::vector<double>& us,
+                            const std::vector<double>& vs,
+                            tplex_alg_data::var_data& vdata,
+                            std::vector<CellVar>& varredcsts,
+                            std::vector<CellVar>& entering_vars)
+{
+    /// local vars
+    NodeArcIdType M;
+    NodeArcIdType k;
+    NodeArcIdType j;
+    double crc;
+    double vmax;
+    double row_ub;
+    double lowest_rd;
+    NodeArcIdTypeSGND lrd_j;
+    /// init local vars
+    M = tpdata_sptr->m;
+    crc = std::numeric_limits<double>::quiet_NaN();
+    vmax = *std::max_element(vs.begin(), vs.end());
+    #ifdef EXPTRACING_2
+    rcs_neg = rcs_0 = rcs_pos = 0;
+    #endif
+    
+    CellVar best(0, 0, std::numeric_limits<double>::max());
+    unsigned long long scanned = 0;
+    unsigned long long next_check = STOPCHECKCELLS;
+    for(NodeArcIdType i = 0; i < M; i++)
+    {
+        /// stop a long scan on cancel or time limit
+        if(scanned >= next_check)
+        {
+            next_check = scanned + STOPCHECKCELLS;
+            if(this->stopRequested())
+                break;
+        }
+        /// costs of row i not lower than u_i + max v - eps cannot price out
+        const double* rcs = vdata.row_cs.data() + this->rowVarBegin(i);
+        const NodeArcIdType* rjs = vdata.row_js.data() + this->rowVarBegin(i);
+        NodeArcIdType RN = this->rowVarBegin(i + 1) - this->rowVarBegin(i);
+        row_ub = us[i] + vmax - MYEPS;
+        lowest_rd = std::numeric_limits<double>::max();
+        lrd_j = -1;
+        for(k = 0; k < RN && rcs[k] < row_ub; k++)
+        {
+            j = rjs[k];
+            if((crc = rcs[k] - us[i] - vs[j]) < -MYEPS)
+            {
+                if(crc + MYEPS < lowest_rd && !(BOUNDED && this->atUpper(vdata, i, j)))
+                {
+                    lowest_rd = crc;
+                    lrd_j = j;
+                }
+                
+                #ifdef EXPTRACING_2
+                comp_negrcs++;
+                rcs_neg++;
+                #endif
+            }
+            #ifdef EXPTRACING_2
+            else if(crc > MYEPS)
+                rcs_pos++;
+            else
+                rcs_0++;
+            comp_rcs++;
+            #endif
+        }
+        pruned_rcs += RN - k;
+        scanned += k;
+        
+        if(lrd_j >= 0)
+        {
+            /// multi-pivoting takes the best var of each row
+            if(algcfg.multipiv)
+                entering_vars.push_back(CellVar(i, lrd_j, lowest_rd));
+            else if(lowest_rd + MYEPS < best.rc)
+                best = CellVar(i, lrd_j, lowest_rd);
+        }
+    }
+    scan_cells = scanned;
+    
+    if(algcfg.multipiv)
+        std::sort(entering_vars.rbegin(), entering_vars.rend());
+    else if(best.rc < -MYEPS)
+        entering_vars.push_back(best);
+    
+    return std::make_pair(true, true);
+}
+
 std::pair<bool,bool>
 TSimplex::computeReducedCostsPol_4(const ts_sol& quantities,
                                    const std::vector<double>& us,
@@ -908,14 +1496,16 @@ TSimplex::computeReducedCostsPol_4(const ts_sol& quantities,
     bool new_neigh = false;
     
     N = tpdata_sptr->n;
+    /// grid sources and destinations, without the slack node of an unbalanced problem
+    const TpInstance::tcosts& costs = tpdata_sptr->costs;
+    NodeArcIdType GM = tpdata_sptr->reduced ? tpdata_sptr->m_orgn : tpdata_sptr->m - (costs.slackSide() == TpCostMatrix::Slack::Source);
+    NodeArcIdType GN = tpdata_sptr->reduced ? tpdata_sptr->n_orgn : tpdata_sptr->n - (costs.slackSide() == TpCostMatrix::Slack::Destination);
     
     /// init board
     if(vdata.board.table.empty() || vdata.board.cell.empty())
     {
         FILE_LOG(logINFO) << "Init shileding data ...";
-        Shielding::THEgenerateSquareGrid(vdata.board,
-                                         tpdata_sptr->reduced ? tpdata_sptr->m_orgn : tpdata_sptr->m, 
-                                         std::sqrt(tpdata_sptr->reduced ? tpdata_sptr->m_orgn : tpdata_sptr->m));
+        Shielding::THEgenerateSquareGrid(vdata.board, GM, std::sqrt(GM));
         vdata.h = 0;
         FILE_LOG(logINFO) << "Done";
     }
@@ -943,7 +1533,8 @@ TSimplex::computeReducedCostsPol_4(const ts_sol& quantities,
                 supp_trnsltd.resize(tpdata_sptr->m_orgn);
                 for(NodeArcIdType i = 0; i < tpdata_sptr->sources_map.size(); i++)
                     for(NodeArcIdType t = 0; t < vdata.supp[i].size(); t++)
-                        supp_trnsltd[tpdata_sptr->sources_map[i]].push_back(tpdata_sptr->destinations_map[vdata.supp[i][t]]);
+                        if(vdata.supp[i][t] < tpdata_sptr->destinations_map.size())
+                            supp_trnsltd[tpdata_sptr->sources_map[i]].push_back(tpdata_sptr->destinations_map[vdata.supp[i][t]]);
                 vdata.supp.swap(supp_trnsltd);
             }
             /// DEV CODE END
@@ -952,12 +1543,15 @@ TSimplex::computeReducedCostsPol_4(const ts_sol& quantities,
             varredcsts.clear();
             
             /// compute neighbor
-            this->compute_shields_v2(tpdata_sptr->costs,
-                                     tpdata_sptr->reduced,
-                                     tpdata_sptr->reduced ? tpdata_sptr->m_orgn : tpdata_sptr->m, 
-                                     tpdata_sptr->reduced ? tpdata_sptr->n_orgn : tpdata_sptr->n,
-                                     std::sqrt(tpdata_sptr->reduced ? tpdata_sptr->m_orgn : tpdata_sptr->m), 
-                                     vdata.board, vdata.supp, varredcsts, EPSQ);
+            this->compute_shields_v2(costs, tpdata_sptr->reduced, GM, GN, std::sqrt(GM), vdata.board, vdata.supp, varredcsts, EPSQ);
+            /// the slack lanes are off the grid, all in the neighborhood
+            for(std::size_t s = 0; s < costs.slackCosts().size(); s++)
+            {
+                if(costs.slackSide() == TpCostMatrix::Slack::Source)
+                    varredcsts.push_back(CellVar(tpdata_sptr->m - 1, s, costs.slackCosts()[s], 0.0));
+                else
+                    varredcsts.push_back(CellVar(s, tpdata_sptr->n - 1, costs.slackCosts()[s], 0.0));
+            }
             new_neigh = true;
             vdata.h = 0;
             
@@ -1005,6 +1599,7 @@ TSimplex::computeReducedCostsPol_4(const ts_sol& quantities,
                 break;
         }
         while(v < varredcsts.size());
+        scan_cells += v;
         
         if(entering_vars.empty() && new_neigh)
              is_opt = true;
@@ -1018,13 +1613,14 @@ TSimplex::computeReducedCostsPol_4(const ts_sol& quantities,
     return std::make_pair(new_neigh, is_opt);
 }
 
+template<bool BOUNDED>
 std::pair<bool,bool>
-TSimplex::computeReducedCostsPol_3(const ts_sol& quantities,
-                                   const std::vector<double>& us,
-                                   const std::vector<double>& vs,
-                                   tplex_alg_data::var_data& vdata,
-                                   std::vector<CellVar>& varredcsts,
-                                   std::vector<CellVar>& entering_vars)
+TSimplex::reducedCostsPol_3(const ts_sol& quantities,
+                            const std::vector<double>& us,
+                            const std::vector<double>& vs,
+                            tplex_alg_data::var_data& vdata,
+                            std::vector<CellVar>& varredcsts,
+                            std::vector<CellVar>& entering_vars)
 {
     /// local vars
     NodeArcIdType M;
@@ -1048,7 +1644,7 @@ TSimplex::computeReducedCostsPol_3(const ts_sol& quantities,
         stop_rcs = false;
         for(auto it = varredcsts.rbegin(); !stop_rcs && it != varredcsts.rend(); it++)
         {
-            if((crc = tpdata_sptr->costs[N * it->i + it->j] - us[it->i] - vs[it->j]) < -MYEPS)
+            if((crc = tpdata_sptr->costs[N * it->i + it->j] - us[it->i] - vs[it->j]) < -MYEPS && !(BOUNDED && this->atUpper(vdata, it->i, it->j)))
             {
                 entering_vars.push_back(CellVar(it->i, it->j, crc));
                 #ifdef EXPTRACING_2
@@ -1068,6 +1664,7 @@ TSimplex::computeReducedCostsPol_3(const ts_sol& quantities,
             #endif
             
             varredcsts.erase((it + 1).base());
+            ++scan_cells;
         }
     }
     /// otherwise, bulid a new list of candidate vars
@@ -1076,30 +1673,47 @@ TSimplex::computeReducedCostsPol_3(const ts_sol& quantities,
         /// compute reduced cost
         NodeArcIdType lim = (M + N) * algcfg.window_size_factor;
         NodeArcIdType u = 0;
+        /// dual bound: vars of the sorted prefix costing at least max u + max v - eps cannot price out
+        NodeArcIdType scan_end = vdata.cs.size();
+        if(vdata.sorted_upto > 0)
+        {
+            double dual_ub = *std::max_element(us.begin(), us.end()) + *std::max_element(vs.begin(), vs.end()) - MYEPS;
+            auto it = std::lower_bound(vdata.cs.begin(), vdata.cs.begin() + vdata.sorted_upto, dual_ub);
+            if(it != vdata.cs.begin() + vdata.sorted_upto)
+                scan_end = it - vdata.cs.begin();
+        }
 
         /// clear
         varredcsts.clear();
         do
         {
-            for( ; u < lim && u < vdata.cs.size(); u++)
+            /// chunks of STOPCHECKCELLS vars, the scan stops on cancel or time limit
+            NodeArcIdType end = std::min(lim, scan_end);
+            while(u < end)
             {
-                if((crc = vdata.cs[u] - us[vdata.is[u]] - vs[vdata.js[u]]) < -MYEPS)
+                NodeArcIdType chk_end = std::min(end, u + STOPCHECKCELLS);
+                for( ; u < chk_end; u++)
                 {
-                    varredcsts.push_back(CellVar(vdata.is[u], vdata.js[u], crc));
+                    if((crc = vdata.cs[u] - us[vdata.is[u]] - vs[vdata.js[u]]) < -MYEPS && !(BOUNDED && this->atUpper(vdata, vdata.is[u], vdata.js[u])))
+                    {
+                        varredcsts.push_back(CellVar(vdata.is[u], vdata.js[u], crc));
+                        #ifdef EXPTRACING_2
+                        comp_negrcs++;
+                        rcs_neg++;
+                        #endif
+                    }
                     #ifdef EXPTRACING_2
-                    comp_negrcs++;
-                    rcs_neg++;
+                    else if(crc > MYEPS)
+                        rcs_pos++;
+                    else
+                        rcs_0++;
+                    comp_rcs++;
                     #endif
                 }
-                #ifdef EXPTRACING_2
-                else if(crc > MYEPS)
-                    rcs_pos++;
-                else
-                    rcs_0++;
-                comp_rcs++;
-                #endif
+                if(u < end && this->stopRequested())
+                    break;
             }
-            if(varredcsts.empty() && lim < vdata.cs.size())
+            if(varredcsts.empty() && lim < scan_end && !scan_stopped)
             {
                 #ifdef LAZYCLUST
                 lim = vdata.cs.size();
@@ -1111,7 +1725,10 @@ TSimplex::computeReducedCostsPol_3(const ts_sol& quantities,
                 break;
         }
         while(varredcsts.empty());
-        allrccomp = (u >= vdata.cs.size());
+        allrccomp = (u >= scan_end);
+        scan_cells += u;
+        if(allrccomp)
+            pruned_rcs += vdata.cs.size() - scan_end;
         rcmem_recomp = true;
         
         #ifdef EXPTRACING_2
@@ -1150,25 +1767,26 @@ TSimplex::computeReducedCostsPol_3(const ts_sol& quantities,
     return std::make_pair(rcmem_recomp, allrccomp);
 }
 
+template<bool BOUNDED>
 std::pair<bool,bool>
-TSimplex::computeReducedCostsPol_1(const ts_sol& quantities,
-                                   const std::vector<double>& us,
-                                   const std::vector<double>& vs,
-                                   tplex_alg_data::var_data& vdata,
-                                   std::vector<CellVar>& varredcsts,
-                                   std::vector<CellVar>& entering_vars)
+TSimplex::reducedCostsPol_1(const ts_sol& quantities,
+                            const std::vector<double>& us,
+                            const std::vector<double>& vs,
+                            tplex_alg_data::var_data& vdata,
+                            std::vector<CellVar>& varredcsts,
+                            std::vector<CellVar>& entering_vars)
 {
     /// local vars
     NodeArcIdType M;
-    NodeArcIdType N;
     double crc;
     double lowest_rd;
+    double vmax;
+    double row_ub;
     NodeArcIdTypeSGND lrd_i;
     NodeArcIdTypeSGND lrd_j;
     bool stoprcc;
     /// init local vars
     M = tpdata_sptr->m;
-    N = tpdata_sptr->n;
     crc = std::numeric_limits<double>::quiet_NaN();
     lowest_rd = std::numeric_limits<double>::max();
     lrd_i = -1;
@@ -1177,12 +1795,38 @@ TSimplex::computeReducedCostsPol_1(const ts_sol& quantities,
     rcs_neg = rcs_0 = rcs_pos = 0;
     #endif
 
+    vmax = *std::max_element(vs.begin(), vs.end());
+    /// arc costs and destinations (sparse instances) by rows
+    const TpCostType* acs = tpdata_sptr->costs.begin();
+    const NodeArcIdType* adst = tpdata_sptr->costs.isSparse() ? tpdata_sptr->costs.arcDestinations().data() : nullptr;
+    const TpCostType* scs = tpdata_sptr->costs.slackCosts().data();
+
     stoprcc = false;
+    unsigned long long scanned = 0;
+    unsigned long long next_check = STOPCHECKCELLS;
     for(NodeArcIdType i = 0; !stoprcc && i < M; i++)
     {
-        for(NodeArcIdType j = 0; !stoprcc && j < N; j++)
+        /// stop a long scan on cancel or time limit
+        if(scanned >= next_check)
+        {
+            next_check = scanned + STOPCHECKCELLS;
+            if(this->stopRequested())
+                break;
+        }
+        /// skip the rest of row i, slack lanes included, from the first block whose suffix min. cost cannot price out
+        std::size_t abeg = this->rowArcBegin(i);
+        std::size_t aend = this->rowArcBegin(i + 1);
+        std::size_t sbeg = tpdata_sptr->costs.slackRowBegin(i);
+        std::size_t send = tpdata_sptr->costs.slackRowBegin(i + 1);
+        const double* sufminc = vdata.row_sufminc.data() + vdata.row_sufbeg[i];
+        std::size_t B = vdata.row_sufbeg[i + 1] - vdata.row_sufbeg[i];
+        row_ub = us[i] + vmax - MYEPS;
+        /// suffix min. costs do not decrease along the row
+        std::size_t b = std::lower_bound(sufminc, sufminc + B, row_ub) - sufminc;
+        std::size_t aupto = std::min(aend, abeg + b * ROWSUFBLK);
+        auto price = [&](NodeArcIdType j, double c)
         {
-            if((crc = tpdata_sptr->costs[N * i + j] - us[i] - vs[j]) < -MYEPS)
+            if((crc = c - us[i] - vs[j]) < -MYEPS && !(BOUNDED && this->atUpper(vdata, i, j)))
             {
                 lowest_rd = crc;
                 lrd_i = i;
@@ -1202,32 +1846,46 @@ TSimplex::computeReducedCostsPol_1(const ts_sol& quantities,
                 rcs_0++;
             comp_rcs++;
             #endif
+        };
+        for(std::size_t a = abeg; !stoprcc && a < aupto; a++)
+            price(adst != nullptr ? adst[a] : a - abeg, acs[a]);
+        if(!stoprcc && b < B)
+        {
+            pruned_rcs += aend - aupto + send - sbeg;
+            scanned += aupto - abeg;
+            continue;
         }
+        /// slack lanes of an unbalanced problem
+        for(std::size_t s = sbeg; !stoprcc && s < send; s++)
+            price(tpdata_sptr->costs.slackDestination(s), scs[s]);
+        scanned += aend - abeg + send - sbeg;
     }
+    scan_cells = scanned;
     if(lrd_i >= 0 && lrd_j >= 0)
         entering_vars.push_back(CellVar(lrd_i, lrd_j, lowest_rd));
     
     return std::make_pair(true, !(lowest_rd + MYEPS < std::numeric_limits<double>::max()));    
 }
 
+template<bool BOUNDED>
 std::pair<bool,bool>
-TSimplex::computeReducedCostsPol_0(const ts_sol& quantities,
-                                   const std::vector<double>& us,
-                                   const std::vector<double>& vs,
-                                   tplex_alg_data::var_data& vdata,
-                                   std::vector<CellVar>& varredcsts,
-                                   std::vector<CellVar>& entering_vars)
+TSimplex::reducedCostsPol_0(const ts_sol& quantities,
+                            const std::vector<double>& us,
+                            const std::vector<double>& vs,
+                            tplex_alg_data::var_data& vdata,
+                            std::vector<CellVar>& varredcsts,
+                            std::vector<CellVar>& entering_vars)
 {
     /// local vars
     NodeArcIdType M;
-    NodeArcIdType N;
     double crc;
     double lowest_rd;
+    double vmax;
+    double row_ub;
     NodeArcIdTypeSGND lrd_i;
     NodeArcIdTypeSGND lrd_j;
     /// init local vars
     M = tpdata_sptr->m;
-    N = tpdata_sptr->n;
     crc = std::numeric_limits<double>::quiet_NaN();
     lowest_rd = std::numeric_limits<double>::max();
     lrd_i = -1;
@@ -1236,13 +1894,39 @@ TSimplex::computeReducedCostsPol_0(const ts_sol& quantities,
     rcs_neg = rcs_0 = rcs_pos = 0;
     #endif
 
+    vmax = *std::max_element(vs.begin(), vs.end());
+    /// arc costs and destinations (sparse instances) by rows
+    const TpCostType* acs = tpdata_sptr->costs.begin();
+    const NodeArcIdType* adst = tpdata_sptr->costs.isSparse() ? tpdata_sptr->costs.arcDestinations().data() : nullptr;
+    const TpCostType* scs = tpdata_sptr->costs.slackCosts().data();
+
+    unsigned long long scanned = 0;
+    unsigned long long next_check = STOPCHECKCELLS;
     for(NodeArcIdType i = 0; i < M; i++)
     {
-        for(NodeArcIdType j = 0; j < N; j++)
+        /// stop a long scan on cancel or time limit
+        if(scanned >= next_check)
+        {
+            next_check = scanned + STOPCHECKCELLS;
+            if(this->stopRequested())
+                break;
+        }
+        /// skip the rest of row i, slack lanes included, from the first block whose suffix min. cost cannot price out
+        std::size_t abeg = this->rowArcBegin(i);
+        std::size_t aend = this->rowArcBegin(i + 1);
+        std::size_t sbeg = tpdata_sptr->costs.slackRowBegin(i);
+        std::size_t send = tpdata_sptr->costs.slackRowBegin(i + 1);
+        const double* sufminc = vdata.row_sufminc.data() + vdata.row_sufbeg[i];
+        std::size_t B = vdata.row_sufbeg[i + 1] - vdata.row_sufbeg[i];
+        row_ub = us[i] + vmax - MYEPS;
+        /// suffix min. costs do not decrease along the row
+        std::size_t b = std::lower_bound(sufminc, sufminc + B, row_ub) - sufminc;
+        std::size_t aupto = std::min(aend, abeg + b * ROWSUFBLK);
+        auto price = [&](NodeArcIdType j, double c)
         {
-            if((crc = tpdata_sptr->costs[N * i + j] - us[i] - vs[j]) < -MYEPS)
+            if((crc = c - us[i] - vs[j]) < -MYEPS)
             {
-                if(crc + MYEPS < lowest_rd)
+                if(crc + MYEPS < lowest_rd && !(BOUNDED && this->atUpper(vdata, i, j)))
                 {
                     lowest_rd = crc;
                     lrd_i = i;
@@ -1262,14 +1946,115 @@ TSimplex::computeReducedCostsPol_0(const ts_sol& quantities,
                 rcs_0++;
             comp_rcs++;
             #endif
+        };
+        for(std::size_t a = abeg; a < aupto; a++)
+            price(adst != nullptr ? adst[a] : a - abeg, acs[a]);
+        if(b < B)
+        {
+            pruned_rcs += aend - aupto + send - sbeg;
+            scanned += aupto - abeg;
+            continue;
         }
+        /// slack lanes of an unbalanced problem
+        for(std::size_t s = sbeg; s < send; s++)
+            price(tpdata_sptr->costs.slackDestination(s), scs[s]);
+        scanned += aend - abeg + send - sbeg;
     }
+    scan_cells = scanned;
     if(lrd_i >= 0 && lrd_j >= 0)
         entering_vars.push_back(CellVar(lrd_i, lrd_j, lowest_rd));
     
     return std::make_pair(true, true);    
 }
 
+std::pair<bool,bool>
+TSimplex::computeReducedCostsPol_5(const ts_sol& quantities,
+                                   const std::vector<double>& us,
+                                   const std::vector<double>& vs,
+                                   tplex_alg_data::var_data& vdata,
+                                   std::vector<CellVar>& varredcsts,
+                                   std::vector<CellVar>& entering_vars)
+{
+    if(vdata.upper.empty())
+        return this->reducedCostsPol_5<false>(quantities, us, vs, vdata, varredcsts, entering_vars);
+    return this->reducedCostsPol_5<true>(quantities, us, vs, vdata, varredcsts, entering_vars);
+}
+
+std::pair<bool,bool>
+TSimplex::computeReducedCostsPol_3(const ts_sol& quantities,
+                                   const std::vector<double>& us,
+                                   const std::vector<double>& vs,
+                                   tplex_alg_data::var_data& vdata,
+                                   std::vector<CellVar>& varredcsts,
+                                   std::vector<CellVar>& entering_vars)
+{
+    if(vdata.upper.empty())
+        return this->reducedCostsPol_3<false>(quantities, us, vs, vdata, varredcsts, entering_vars);
+    return this->reducedCostsPol_3<true>(quantities, us, vs, vdata, varredcsts, entering_vars);
+}
+
+std::pair<bool,bool>
+TSimplex::computeReducedCostsPol_1(const ts_sol& quantities,
+                                   const std::vector<double>& us,
+                                   const std::vector<double>& vs,
+                                   tplex_alg_data::var_data& vdata,
+                                   std::vector<CellVar>& varredcsts,
+                                   std::vector<CellVar>& entering_vars)
+{
+    if(vdata.upper.empty())
+        return this->reducedCostsPol_1<false>(quantities, us, vs, vdata, varredcsts, entering_vars);
+    return this->reducedCostsPol_1<true>(quantities, us, vs, vdata, varredcsts, entering_vars);
+}
+
+std::pair<bool,bool>
+TSimplex::computeReducedCostsPol_0(const ts_sol& quantities,
+                                   const std::vector<double>& us,
+                                   const std::vector<double>& vs,
+                                   tplex_alg_data::var_data& vdata,
+                                   std::vector<CellVar>& varredcsts,
+                                   std::vector<CellVar>& entering_vars)
+{
+    if(vdata.upper.empty())
+        return this->reducedCostsPol_0<false>(quantities, us, vs, vdata, varredcsts, entering_vars);
+    return this->reducedCostsPol_0<true>(quantities, us, vs, vdata, varredcsts, entering_vars);
+}
+
+void TSimplex::priceUpperVars(const std::vector<double>& us, const std::vector<double>& vs, const tplex_alg_data::var_data& vdata,
+                              std::vector<CellVar>& entering_vars)
+{
+    const TpCapacities& caps = tpdata_sptr->capacities;
+    double crc;
+    double highest_rd = MYEPS;
+    NodeArcIdTypeSGND hrd_k = -1;
+    for(auto it = vdata.upper.begin(); it != vdata.upper.end(); it++)
+    {
+        NodeArcIdType i = caps.row(*it);
+        NodeArcIdType j = caps.col(*it);
+        if((crc = tpdata_sptr->costs[tpdata_sptr->n * i + j] - us[i] - vs[j]) > highest_rd)
+        {
+            highest_rd = crc;
+            hrd_k = *it;
+        }
+    }
+    scan_cells += vdata.upper.size();
+    
+    if(hrd_k < 0 || (!entering_vars.empty() && !(-highest_rd < entering_vars.front().rc)))
+        return;
+    entering_vars.assign(1, CellVar(caps.row(hrd_k), caps.col(hrd_k), -highest_rd));
+}
+
+std::pair<double, double> TSimplex::solutionObjF(const std::shared_ptr<tplex_alg_data>& tplxd_sptr, const std::shared_ptr<SpanningTree>& bspat_sptr)
+{
+    std::pair<double, double> objf_and_tsq = bspat_sptr->computeTSpxObjF(tpdata_sptr->costs, tplxd_sptr->quantities);
+    const TpCapacities& caps = tpdata_sptr->capacities;
+    for(auto it = tplxd_sptr->vdata.upper.begin(); it != tplxd_sptr->vdata.upper.end(); it++)
+    {
+        objf_and_tsq.first += tpdata_sptr->costs[tpdata_sptr->n * caps.row(*it) + caps.col(*it)] * caps.capacity(*it);
+        objf_and_tsq.second += caps.capacity(*it);
+    }
+    return objf_and_tsq;
+}
+
 TSimplex::pivs_data
 TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr, 
                    const std::shared_ptr<SpanningTree>& bspat_sptr, 
@@ -1278,10 +2063,14 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
                    double& tot_q,
                    bool update_rwcl_sol)
 {
+    if(!tpdata_sptr->capacities.empty())
+        return this->boundedPivoting(tplexd_sptr, bspat_sptr, entering_vars, update_rwcl_sol);
+    
     #ifdef EXPTRACING_2
     double objfv_on_entrance = objf_value;
     deg_bchng_ctr = 0;
     #endif
+    deg_pivots = 0;
 
     //std::stringstream ss;
     std::vector<CellVar> exited_vars;
@@ -1298,6 +2087,15 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
     double s2tm = std::numeric_limits<double>::quiet_NaN();
     bool is_multipiv = algcfg.multipiv && entering_vars.size() > 1;
     bool compute_loop;
+    /// parallel step 1: the tree is not updated in step 1, loops of a batch are computed concurrently
+    bool par_step1 = is_multipiv && algcfg.threads > 1;
+    std::size_t par_batch = PARPIVBATCH * algcfg.threads;
+    std::size_t batch_beg = 0;
+    std::vector<Loop> batch_loops;
+    std::vector<loop_probe> batch_probes;
+    std::vector<bool> batch_checked;
+    if(par_step1 && node_stamps.size() != tpdata_sptr->m + tpdata_sptr->n)
+        node_stamps.assign(tpdata_sptr->m + tpdata_sptr->n, 0);
     
     /// start chrono
     auto start_s1 = std::chrono::steady_clock::now();
@@ -1307,6 +2105,22 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
     succes_lpsrch = failed_lpsrch = saved_lpsrch = iter = 0;
     for(auto evit = entering_vars.begin(); evit != entering_vars.end(); evit++)
     {
+        if(par_step1 && std::size_t(evit - entering_vars.begin()) % par_batch == 0)
+        {
+            batch_beg = evit - entering_vars.begin();
+            /// the spanning tree check filters the vars of the batch before their loops are searched, a var
+            /// passing it later, with the colors of the earlier pivots, gets its loop searched in turn
+            std::size_t batch_end = std::min(batch_beg + par_batch, entering_vars.size());
+            batch_checked.assign(batch_end - batch_beg, true);
+            if(algcfg.spatvarsel)
+                for(std::size_t k = batch_beg; k < batch_end; k++)
+                    batch_checked[k - batch_beg] = bspat_sptr->checkArc(std::make_pair(entering_vars[k].i, tpdata_sptr->m + entering_vars[k].j),
+                                                                        algcfg.spatvarsel_greed_lvl);
+            this->findLoopsBatch(tplexd_sptr->quantities, bspat_sptr, entering_vars,
+                                 batch_beg, batch_end, batch_loops, batch_probes, false, &batch_checked);
+            ++stamp_epoch;
+        }
+        
         #ifdef INSVS
         if(tplexd_sptr->quantities.contains(evit->i * tpdata_sptr->n + evit->j))
         {
@@ -1322,8 +2136,24 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
                                                , &odk_counter
                                                #endif
                                                );
+        auto st_i = Instr::tick(instr, Instr::FIND_LOOP);
         Loop loop(tpdata_sptr->n);
-        if(compute_loop)
+        if(compute_loop && par_step1 && !batch_loops[evit - entering_vars.begin() - batch_beg].empty())
+        {
+            /// theta is stale if an earlier var of the batch moved q. along the loop
+            loop.swap(batch_loops[evit - entering_vars.begin() - batch_beg]);
+            min_q = batch_probes[evit - entering_vars.begin() - batch_beg].minq;
+            if(this->isLoopStamped(loop))
+                min_q = loop.getMinQ(tplexd_sptr->quantities).first;
+            
+            #ifdef EXPTRACING_2
+            if(!(min_q > MYEPS))
+                failed_lpsrch++;
+            else
+                succes_lpsrch++;
+            #endif
+        }
+        else if(compute_loop)
         {
             #ifdef EXPTRACING_2
             auto st_fl = std::chrono::steady_clock::now();
@@ -1348,6 +2178,8 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
             #ifdef EXPTRACING_2
             saved_lpsrch++;
             #endif
+            if(instr != nullptr)
+                instr->counters[Instr::SAVED_LOOP_SEARCHES]++;
             
             /// skip var
             if(is_multipiv)
@@ -1364,7 +2196,7 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
             continue;
         }
         #endif
-        
+        
         #ifdef EXPTRACING_2
         total_loop_len += loop.size();
         total_loop_len_f1 += loop.size();
@@ -1377,6 +2209,14 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
             ++espqbchng_counter, ++deg_bchng_ctr;
         #endif
         
+        if(!(min_q > MYEPS))
+            ++deg_pivots;
+        if(instr != nullptr)
+        {
+            instr->counters[Instr::LOOPS]++;
+            instr->hists[Instr::LOOP_LEN_STEP1].add(loop.size());
+        }
+        
         /// move quantities and erase zeroed cell
         unzeroed_vars.clear();
         loop.moveQuantity(min_q, tpdata_sptr->costs, tplexd_sptr->quantities, !is_multipiv ? exited_vars : zeroed_vars, unzeroed_vars, 
@@ -1386,6 +2226,9 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
                           nullptr, 
                           #endif
                           nullptr, !is_multipiv);
+        if(par_step1)
+            this->stampLoop(loop);
+        Instr::tock(instr, Instr::FIND_LOOP, st_i);
         
         #ifdef EXPTRACING_2
         tm2fndloop += GETOPTTMS(st_fl);
@@ -1401,12 +2244,15 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
                 tplexd_sptr->addVar(*evit, tpdata_sptr->costs[tpdata_sptr->n * evit->i + evit->j]);
             }
             /// update SPAT
+            Instr::scoped_timer itm(instr, Instr::TREE_UPDATE);
             bspat_sptr->update(std::make_pair(exited_vars[0].i, tpdata_sptr->m + exited_vars[0].j), std::make_pair(evit->i, tpdata_sptr->m + evit->j)
                                #ifdef EXPTRACING_2
                                , false
                                , &tree_update_counter
                                #endif
                                );
+            if(instr != nullptr)
+                instr->counters[Instr::TREE_UPDATES]++;
         }
         else if(algcfg.spatvarsel)
         {
@@ -1468,29 +2314,52 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
     auto start_s2 = std::chrono::steady_clock::now();
     
     /// V2 code
+    /// parallel step 2: loops and direction probes of a batch are computed speculatively on the current tree,
+    /// a loop is still valid at commit time if no earlier commit of the batch touched its nodes
+    bool par_step2 = algcfg.threads > 1;
+    loop_probe probe;
     iter = 0;
     for(auto it = entering_vars.begin(); it != entering_vars.end(); it++)
     {
+        if(par_step2 && std::size_t(it - entering_vars.begin()) % par_batch == 0)
+        {
+            batch_beg = it - entering_vars.begin();
+            this->findLoopsBatch(tplexd_sptr->quantities, bspat_sptr, entering_vars,
+                                 batch_beg, std::min(batch_beg + par_batch, entering_vars.size()),
+                                 batch_loops, batch_probes, true);
+            ++stamp_epoch;
+        }
+        
         if(std::isnan(it->rc))
             continue;
         
-        tmp_objf_impr = tmp_objf_impr_minus = 0.0;        
         Loop loop(tpdata_sptr->n);
 
+        auto st_i = Instr::tick(instr, Instr::FIND_LOOP);
         #ifdef EXPTRACING_2
         auto st_fl = std::chrono::steady_clock::now();
-        bspat_sptr->findLoop(*it, loop, &total_path_len_f2);
-        #else
-        bspat_sptr->findLoop(*it, loop);
         #endif
-
-        /// check if improve in direction plus
-        min_q = loop.getMinQ(tplexd_sptr->quantities, true, true).first;
-        loop.moveQuantity(min_q, tpdata_sptr->costs, tplexd_sptr->quantities, exited_vars, unzeroed_vars, &tmp_objf_impr, nullptr, false, true, true);
-        
-        /// check if improve in direction minus
-        min_q_minus = loop.getMinQ(tplexd_sptr->quantities, false, true).first;
-        loop.moveQuantity(min_q_minus, tpdata_sptr->costs, tplexd_sptr->quantities, exited_vars, unzeroed_vars, &tmp_objf_impr_minus, nullptr, false, true, false);
+        if(par_step2 && !batch_loops[it - entering_vars.begin() - batch_beg].empty()
+                     && !this->isLoopStamped(batch_loops[it - entering_vars.begin() - batch_beg]))
+        {
+            loop.swap(batch_loops[it - entering_vars.begin() - batch_beg]);
+            probe = batch_probes[it - entering_vars.begin() - batch_beg];
+        }
+        else
+        {
+            #ifdef EXPTRACING_2
+            bspat_sptr->findLoop(*it, loop, &total_path_len_f2);
+            #else
+            bspat_sptr->findLoop(*it, loop);
+            #endif
+            
+            /// check if improve in direction plus and minus
+            this->probeLoop(tplexd_sptr->quantities, loop, probe);
+        }
+        min_q = probe.minq;
+        min_q_minus = probe.minq_minus;
+        tmp_objf_impr = probe.impr;
+        tmp_objf_impr_minus = probe.impr_minus;
         
         /// logging ::: warning
         #ifdef EXPTRACING_2
@@ -1506,7 +2375,8 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
         }
         #endif
         /// main program swith
-        if(tmp_objf_impr - tmp_objf_impr_minus < ERTV || (std::abs(tmp_objf_impr) < ERTV && std::abs(tmp_objf_impr_minus) < ERTV))
+        bool dir_plus = tmp_objf_impr - tmp_objf_impr_minus < ERTV || (std::abs(tmp_objf_impr) < ERTV && std::abs(tmp_objf_impr_minus) < ERTV);
+        if(dir_plus)
         {
             loop.moveQuantity(min_q, tpdata_sptr->costs, tplexd_sptr->quantities, exited_vars, unzeroed_vars,
                               #ifdef EXPTRACING_2
@@ -1549,6 +2419,15 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
            #endif
         }
         
+        if(par_step2)
+            this->stampLoop(loop);
+        if(instr != nullptr)
+        {
+            Instr::tock(instr, Instr::FIND_LOOP, st_i);
+            instr->counters[Instr::LOOPS]++;
+            instr->hists[Instr::LOOP_LEN_STEP2].add(loop.size());
+        }
+        
         #ifdef EXPTRACING_2
         tm2fndloop += GETOPTTMS(st_fl);
         auto st_ut = std::chrono::steady_clock::now();
@@ -1557,6 +2436,8 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
         /// add the new cell
         if(tplexd_sptr->quantities.contains(tpdata_sptr->n * it->i + it->j))
         {
+            if(!((dir_plus ? min_q : min_q_minus) > MYEPS))
+                ++deg_pivots;
             /// update rows/cols data
             if(update_rwcl_sol)
             {
@@ -1564,6 +2445,7 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
                 tplexd_sptr->addVar(*it, tpdata_sptr->costs[tpdata_sptr->n * it->i + it->j]);
             }
             /// update SPAT
+            Instr::scoped_timer itm(instr, Instr::TREE_UPDATE);
             bspat_sptr->update(std::make_pair(exited_vars.back().i, tpdata_sptr->m + exited_vars.back().j), 
                                std::make_pair(it->i, tpdata_sptr->m + it->j)
                                , false
@@ -1571,6 +2453,8 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
                                , &tree_update_counter
                                #endif
                                );
+            if(instr != nullptr)
+                instr->counters[Instr::TREE_UPDATES]++;
         }
         
         #ifdef EXPTRACING_2
@@ -1591,6 +2475,275 @@ TSimplex::pivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
     return std::make_tuple(iter, saved_lpsrch, failed_lpsrch, succes_lpsrch, s1tm, s2tm);
 }
 
+TSimplex::pivs_data
+TSimplex::boundedPivoting(const std::shared_ptr<tplex_alg_data>& tplexd_sptr,
+                          const std::shared_ptr<SpanningTree>& bspat_sptr,
+                          std::vector<CellVar>& entering_vars,
+                          bool update_rwcl_sol)
+{
+    const TpCapacities& caps = tpdata_sptr->capacities;
+    tplex_alg_data::var_data& vdata = tplexd_sptr->vdata;
+    unsigned long iter = 0;
+    deg_pivots = 0;
+    
+    auto start_s1 = std::chrono::steady_clock::now();
+    for(auto evit = entering_vars.begin(); evit != entering_vars.end(); evit++)
+    {
+        /// a var at its upper bound enters decreasing
+        std::ptrdiff_t ek = caps.find(evit->i, evit->j);
+        bool incr = !(ek >= 0 && vdata.upper_pos[ek] >= 0);
+        
+        auto st_i = Instr::tick(instr, Instr::FIND_LOOP);
+        Loop loop(tpdata_sptr->n);
+        bspat_sptr->findLoop(*evit, loop);
+        std::pair<double, NodeArcIdType> theta = loop.getBoundedMinQ(tplexd_sptr->quantities, caps, incr);
+        if(!(theta.first > MYEPS))
+            ++deg_pivots;
+        if(instr != nullptr)
+        {
+            instr->counters[Instr::LOOPS]++;
+            instr->hists[Instr::LOOP_LEN_STEP1].add(loop.size());
+        }
+        
+        CellVar exv(loop[theta.second].i, loop[theta.second].j, 0.0);
+        /// the blocking stone leaves at its upper bound if it increases
+        bool exit_upper = theta.second > 0 && ((theta.second & 1) != 0) != incr;
+        loop.moveBoundedQuantity(theta.first, theta.second, caps, tplexd_sptr->quantities, incr);
+        Instr::tock(instr, Instr::FIND_LOOP, st_i);
+        ++iter;
+        
+        /// bound flip, the basis does not change
+        if(theta.second == 0)
+        {
+            vdata.setUpper(ek, incr);
+            continue;
+        }
+        if(!incr)
+            vdata.setUpper(ek, false);
+        if(exit_upper)
+            vdata.setUpper(caps.find(exv.i, exv.j), true);
+        
+        /// update rows/cols data
+        if(update_rwcl_sol)
+        {
+            tplexd_sptr->delVar(exv);
+            tplexd_sptr->addVar(*evit, tpdata_sptr->costs[tpdata_sptr->n * evit->i + evit->j]);
+        }
+        /// update SPAT
+        Instr::scoped_timer itm(instr, Instr::TREE_UPDATE);
+        bspat_sptr->update(std::make_pair(exv.i, tpdata_sptr->m + exv.j), std::make_pair(evit->i, tpdata_sptr->m + evit->j));
+        if(instr != nullptr)
+            instr->counters[Instr::TREE_UPDATES]++;
+    }
+    
+    return std::make_tuple(iter, 0, 0, 0, GETOPTTMS(start_s1), 0.0);
+}
+
+void TSimplex::findLoopsBatch(const ts_sol& quantities,
+                              const std::shared_ptr<SpanningTree>& bspat_sptr,
+                              const std::vector<CellVar>& entering_vars,
+                              std::size_t beg, std::size_t end,
+                              std::vector<Loop>& loops,
+                              std::vector<loop_probe>& probes,
+                              bool probe_dirs,
+                              const std::vector<bool>* checked)
+{
+    loops.clear();
+    for(std::size_t k = beg; k < end; k++)
+        loops.emplace_back(tpdata_sptr->n);
+    probes.assign(end - beg, loop_probe());
+    
+    /// in step 1, loops of vars already in the solution or not passing the tree check are left empty
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(algcfg.threads)
+    for(long long k = 0; k < (long long)(end - beg); k++)
+    {
+        const CellVar& ev = entering_vars[beg + k];
+        if(std::isnan(ev.rc) || (!probe_dirs && quantities.contains(ev.i * tpdata_sptr->n + ev.j))
+                             || (checked != nullptr && !(*checked)[k]))
+            continue;
+        
+        #ifdef LOOPOP
+        bspat_sptr->findLoop(ev, loops[k]);
+        #else
+        bspat_sptr->findLoopOP(ev, loops[k]);
+        #endif
+        if(probe_dirs)
+            this->probeLoop(quantities, loops[k], probes[k]);
+        else
+            probes[k].minq = loops[k].getMinQ(quantities).first;
+    }
+}
+
+void TSimplex::probeLoop(const ts_sol& quantities, Loop& loop, loop_probe& probe)
+{
+    std::vector<CellVar> exited_vars;
+    std::vector<CellVar> unzeroed_vars;
+    /// moveQuantity does not write quantities when just checking
+    ts_sol& qs = const_cast<ts_sol&>(quantities);
+    
+    probe.impr = probe.impr_minus = 0.0;
+    /// direction plus
+    probe.minq = loop.getMinQ(qs, true, true).first;
+    loop.moveQuantity(probe.minq, tpdata_sptr->costs, qs, exited_vars, unzeroed_vars, &probe.impr, nullptr, false, true, true);
+    /// direction minus
+    probe.minq_minus = loop.getMinQ(qs, false, true).first;
+    loop.moveQuantity(probe.minq_minus, tpdata_sptr->costs, qs, exited_vars, unzeroed_vars, &probe.impr_minus, nullptr, false, true, false);
+}
+
+bool TSimplex::isLoopStamped(const Loop& loop)
+{
+    for(auto it = loop.begin(); it != loop.end(); it++)
+        if(node_stamps[it->i] == stamp_epoch || node_stamps[tpdata_sptr->m + it->j] == stamp_epoch)
+            return true;
+    
+    return false;
+}
+
+void TSimplex::stampLoop(const Loop& loop)
+{
+    for(auto it = loop.begin(); it != loop.end(); it++)
+        node_stamps[it->i] = node_stamps[tpdata_sptr->m + it->j] = stamp_epoch;
+}
+
+long TSimplex::dualPivoting(const std::shared_ptr<tplex_alg_data>& tplxd_sptr,
+                            const std::shared_ptr<SpanningTree>& bspat_sptr)
+{
+    NodeArcIdType M = tpdata_sptr->m;
+    NodeArcIdType N = tpdata_sptr->n;
+    NodeArcIdType max_pivots = 10 * (M + N);
+    SpanningTree::NodeType pnd;
+    std::vector<SpanningTree::NodeType> subtree;
+    std::vector<bool> in_subtree(M + N, false);
+    std::vector<long> on_path(M + N, -1);
+    std::vector<NodeArcIdType> rows;
+    std::vector<NodeArcIdType> cols;
+    std::vector<std::pair<NodeArcIdType, double>> cycle;
+    long pivots = 0;
+    #ifdef EPSQIS0
+    double zq = 0.0;
+    #else
+    double zq = EPSQ;
+    #endif
+    
+    /// flows and multipliers of the whole tree once, the pivots update them
+    bspat_sptr->computeTSpxFlows(tpdata_sptr->sources, tpdata_sptr->destinations, tplxd_sptr->quantities, zq);
+    bspat_sptr->computeTSpxMultips(tpdata_sptr->costs, tplxd_sptr->us, tplxd_sptr->vs);
+    while(true)
+    {
+        /// leaving var: the most negative flow
+        NodeArcIdType lr = 0;
+        NodeArcIdType lc = 0;
+        double minq = 0.0;
+        for(NodeArcIdType nd = 0; nd < M + N; nd++)
+        {
+            if((pnd = bspat_sptr->getPredecessor(nd)) < 0)
+                continue;
+            NodeArcIdType r = nd < M ? nd : pnd;
+            NodeArcIdType c = nd < M ? pnd - M : nd - M;
+            if(tplxd_sptr->quantities.get(N * r + c) < minq)
+                minq = tplxd_sptr->quantities.get(N * r + c), lr = r, lc = c;
+        }
+        if(minq >= -MYEPS)
+            break;
+        if((NodeArcIdType)pivots >= max_pivots)
+            return -1;
+        
+        /// removing the leaving var splits the tree: the flow of the leaving var grows
+        /// with vars from the rows on its column side to the columns on its row side,
+        /// one end of the entering var is in the subtree below the leaving var
+        bool row_below = bspat_sptr->getPredecessor(lr) == SpanningTree::NodeType(M + lc);
+        bspat_sptr->getSubtreeNodes(row_below ? lr : M + lc, subtree);
+        rows.clear();
+        cols.clear();
+        for(auto it = subtree.begin(); it != subtree.end(); it++)
+        {
+            in_subtree[*it] = true;
+            if(row_below && *it >= SpanningTree::NodeType(M))
+                cols.push_back(*it - M);
+            else if(!row_below && *it < SpanningTree::NodeType(M))
+                rows.push_back(*it);
+        }
+        if(row_below)
+        {
+            for(NodeArcIdType i = 0; i < M; i++)
+                if(!in_subtree[i])
+                    rows.push_back(i);
+        }
+        else
+        {
+            for(NodeArcIdType j = 0; j < N; j++)
+                if(!in_subtree[M + j])
+                    cols.push_back(j);
+        }
+        for(auto it = subtree.begin(); it != subtree.end(); it++)
+            in_subtree[*it] = false;
+        
+        /// entering var: the min. reduced cost, i.e., the dual ratio test
+        NodeArcIdType er = M;
+        NodeArcIdType ec = N;
+        double minrc = std::numeric_limits<double>::max();
+        double crc;
+        for(auto rit = rows.begin(); rit != rows.end(); rit++)
+        {
+            for(auto cit = cols.begin(); cit != cols.end(); cit++)
+            {
+                if((crc = tpdata_sptr->costs[N * (*rit) + (*cit)] - tplxd_sptr->us[*rit] - tplxd_sptr->vs[*cit]) < minrc)
+                    minrc = crc, er = *rit, ec = *cit;
+            }
+        }
+        if(er == M)
+            return -1;
+        
+        /// cycle of the entering var: the tree paths of its ends up to their common ancestor,
+        /// the tree vars alternate signs starting with minus at both ends
+        cycle.clear();
+        for(SpanningTree::NodeType nd = er; nd >= 0; nd = bspat_sptr->getPredecessor(nd))
+            on_path[nd] = pivots;
+        SpanningTree::NodeType cnd = M + ec;
+        double sgn = -1.0;
+        for(; on_path[cnd] != pivots; cnd = pnd, sgn = -sgn)
+        {
+            pnd = bspat_sptr->getPredecessor(cnd);
+            cycle.push_back(std::make_pair(cnd < SpanningTree::NodeType(M) ? N * cnd + (pnd - M) : N * pnd + (cnd - M), sgn));
+        }
+        sgn = -1.0;
+        for(SpanningTree::NodeType nd = er; nd != cnd; nd = pnd, sgn = -sgn)
+        {
+            pnd = bspat_sptr->getPredecessor(nd);
+            cycle.push_back(std::make_pair(nd < SpanningTree::NodeType(M) ? N * nd + (pnd - M) : N * pnd + (nd - M), sgn));
+        }
+        
+        /// flows: theta along the cycle zeroes the leaving var
+        double theta = 0.0;
+        for(auto it = cycle.begin(); it != cycle.end(); it++)
+            if(it->first == N * lr + lc)
+                theta = -minq * it->second;
+        for(auto it = cycle.begin(); it != cycle.end(); it++)
+        {
+            double q = tplxd_sptr->quantities.get(it->first) + it->second * theta;
+            tplxd_sptr->quantities.set(it->first, q < -MYEPS || q >= MYEPS ? q : zq);
+        }
+        tplxd_sptr->quantities.set(N * er + ec, theta < -MYEPS || theta >= MYEPS ? theta : zq);
+        
+        /// basis change
+        tplxd_sptr->quantities.remove(N * lr + lc);
+        bspat_sptr->update(std::make_pair(lr, M + lc), std::make_pair(er, M + ec));
+        ++pivots;
+        
+        /// multipliers: the subtree moves with the entering var, the reduced cost of which gets zero
+        double dlt = row_below ? -minrc : minrc;
+        for(auto it = subtree.begin(); it != subtree.end(); it++)
+        {
+            if(*it < SpanningTree::NodeType(M))
+                tplxd_sptr->us[*it] += dlt;
+            else
+                tplxd_sptr->vs[*it - M] -= dlt;
+        }
+    }
+    
+    return pivots;
+}
+
 tplex_alg_data::tplex_alg_data(const std::shared_ptr<TpInstance::TProblemData>& tpdsptr, bool to_fill)
     : quantities(ts_sol(tpdsptr->m * tpdsptr->n, std::numeric_limits<double>::quiet_NaN()))
     , us(std::vector<double>(tpdsptr->m, std::numeric_limits<double>::quiet_NaN()))
@@ -1600,11 +2753,15 @@ tplex_alg_data::tplex_alg_data(const std::shared_ptr<TpInstance::TProblemData>&
     if(to_fill)
     {
         rows.resize(tpdsptr->m, std::vector<CellVar>());
-        for(auto it = rows.begin(); it != rows.end(); it++)
-            it->reserve(tpdsptr->n);
         cols.resize(tpdsptr->n, std::vector<CellVar>());
-        for(auto it = cols.begin(); it != cols.end(); it++)
-            it->reserve(tpdsptr->m);
+        /// no dense reservation for sparse instances, memory scales with the arcs
+        if(!tpdsptr->costs.isSparse())
+        {
+            for(auto it = rows.begin(); it != rows.end(); it++)
+                it->reserve(tpdsptr->n);
+            for(auto it = cols.begin(); it != cols.end(); it++)
+                it->reserve(tpdsptr->m);
+        }
     }
     else
     {
@@ -1634,6 +2791,8 @@ void tplex_alg_data::sort()
 
     for(NodeArcIdType j = 0; j < cols.size(); j++)
         std::sort(cols[j].begin(), cols[j].end(), [](const CellVar& lhs, const CellVar& rhs) { return lhs.cost >= rhs.cost + MYEPS; });
+    if(!rows_cpos.empty())
+        this->indexRowsCols();
 }
 
 
@@ -1645,25 +2804,131 @@ inline tplex_alg_data::tplex_alg_data::tplex_alg_data(const tplex_alg_data& arg)
 
 inline void tplex_alg_data::tplex_alg_data::addVar(CellVar& ev, double c)
 {
+    rows_cpos[ev.i].push_back(cols[ev.j].size());
+    cols_rpos[ev.j].push_back(rows[ev.i].size());
     rows[ev.i].push_back(CellVar(ev.i, ev.j, c, 0.0));
     cols[ev.j].push_back(CellVar(ev.i, ev.j, c, 0.0));
 }
 inline void tplex_alg_data::tplex_alg_data::delVar(CellVar& exv)
 {
-    for(auto it = rows[exv.i].rbegin(); it != rows[exv.i].rend(); it++)
-        if(it->j == exv.j)
-            rows[exv.i].erase((it + 1).base());
-    for(auto it = cols[exv.j].rbegin(); it != cols[exv.j].rend(); it++)
-        if(it->i == exv.i)
-            cols[exv.j].erase((it + 1).base());
+    std::vector<CellVar>& row = rows[exv.i];
+    std::vector<CellVar>& col = cols[exv.j];
+    std::vector<NodeArcIdType>& row_cp = rows_cpos[exv.i];
+    std::vector<NodeArcIdType>& col_rp = cols_rpos[exv.j];
+    /// the var is looked up in the shorter of its row and col (a basis has 2 vars per node on average),
+    /// its cross position gives the other
+    NodeArcIdType rp = 0;
+    NodeArcIdType cp = 0;
+    if(row.size() <= col.size())
+    {
+        while(rp < row.size() && row[rp].j != exv.j)
+            ++rp;
+        if(rp == row.size())
+            throw std::runtime_error("Exiting var " + exv.toString() + " is not in the basis by rows and cols");
+        cp = row_cp[rp];
+    }
+    else
+    {
+        while(cp < col.size() && col[cp].i != exv.i)
+            ++cp;
+        if(cp == col.size())
+            throw std::runtime_error("Exiting var " + exv.toString() + " is not in the basis by rows and cols");
+        rp = col_rp[cp];
+    }
+    /// swap with the last var of the row and of the col, then pop
+    if(rp + 1 < row.size())
+    {
+        row[rp] = row.back();
+        row_cp[rp] = row_cp.back();
+        cols_rpos[row[rp].j][row_cp[rp]] = rp;
+    }
+    row.pop_back();
+    row_cp.pop_back();
+    if(cp + 1 < col.size())
+    {
+        col[cp] = col.back();
+        col_rp[cp] = col_rp.back();
+        rows_cpos[col[cp].i][col_rp[cp]] = cp;
+    }
+    col.pop_back();
+    col_rp.pop_back();
+}
+
+void tplex_alg_data::indexRowsCols()
+{
+    const NodeArcIdType M = rows.size();
+    const NodeArcIdType N = cols.size();
+    rows_cpos.resize(M);
+    cols_rpos.resize(N);
+    for(NodeArcIdType i = 0; i < M; i++)
+        rows_cpos[i].resize(rows[i].size());
+    for(NodeArcIdType j = 0; j < N; j++)
+        cols_rpos[j].resize(cols[j].size());
+    /// col positions of the vars of row i, by col
+    std::vector<NodeArcIdType> col_pos(N);
+    std::vector<std::vector<std::pair<NodeArcIdType, NodeArcIdType>>> by_row(M);
+    for(NodeArcIdType j = 0; j < N; j++)
+        for(NodeArcIdType p = 0; p < cols[j].size(); p++)
+            by_row[cols[j][p].i].push_back(std::make_pair(j, p));
+    for(NodeArcIdType i = 0; i < M; i++)
+    {
+        for(auto it = by_row[i].begin(); it != by_row[i].end(); it++)
+            col_pos[it->first] = it->second;
+        for(NodeArcIdType p = 0; p < rows[i].size(); p++)
+        {
+            rows_cpos[i][p] = col_pos[rows[i][p].j];
+            cols_rpos[rows[i][p].j][rows_cpos[i][p]] = p;
+        }
+    }
 }
 
 void tplex_alg_data::clearSol()
 {
-    quantities = ts_sol(rows.size() * cols.size(), std::numeric_limits<double>::quiet_NaN());
+    quantities.reset();
     for(NodeArcIdType i = 0; i < rows.size(); i++)
         rows[i].clear();
     for(NodeArcIdType j = 0; j < cols.size(); j++)
         cols[j].clear();
+    rows_cpos.clear();
+    cols_rpos.clear();
     solution.clear();
 }
+
+void tplex_alg_data::reset()
+{
+    this->clearSol();
+    partial_basis_size = 0;
+    std::fill(us.begin(), us.end(), std::numeric_limits<double>::quiet_NaN());
+    std::fill(vs.begin(), vs.end(), std::numeric_limits<double>::quiet_NaN());
+    vdata.clear();
+}
+
+void tplex_alg_data::var_data::clear()
+{
+    cs.clear();
+    is.clear();
+    js.clear();
+    sorted_upto = 0;
+    cs_pos.clear();
+    row_sufbeg.clear();
+    row_sufminc.clear();
+    row_cs.clear();
+    row_js.clear();
+    board = Shielding::THEgrid();
+    supp.clear();
+    spat_sptr.reset();
+    h = 0;
+    next_arc = 0;
+    next_flag = true;
+    vs_max.clear();
+    b.clear();
+    Lrow.clear();
+    Lmax.clear();
+    row_rotors.clear();
+    row_rotors_0.clear();
+    rotor_flags.clear();
+    rcneg_flags.clear();
+    row_flags.clear();
+    upper.clear();
+    upper_pos.clear();
+}
@@ -42,14 +42,19 @@
 #endif
 
 #include <memory>
+#include <atomic>
+#include <functional>
+#include <chrono>
 #include <vector>
 #include <list>
 #include <limits>
 #include <unordered_map>
+#include <tuple>
 
 #include "TpInstance.h"
 #include "TSimplexDatastructs.h"
 #include "optresult.h"
+#include "instr.h"
 
 //#define EXPNET
 
@@ -66,6 +71,8 @@ std::pair<bool,bool> mname(const ts_sol&, \
 
 class TSimplex
 {
+    /// micro-benchmarks of the private kernels, see tools/iiobench.cpp
+    friend class TSimplexBench;
 public:
     TSimplex(const std::shared_ptr<TpInstance::TProblemData>&,
              unsigned long long mode = 0,
@@ -75,6 +82,33 @@ public:
     ~TSimplex();
     
     void setVerbose();
+    void setThreads(unsigned int);
+    /// start tsimplex(..) from the basis of the previous solve if still primal feasible
+    void setWarmStart(bool);
+    /// tsimplex(..) stops, not optimal, as soon as the flag is set
+    void setCancelFlag(const std::atomic<bool>*);
+    /// progress of tsimplex(..), see setProgressCallback(..)
+    struct progress_info
+    {
+        unsigned long iter = 0;
+        unsigned long super_iter = 0;
+        unsigned long basis_changes = 0;
+        double objf_value = 0.0;
+        double elapsed_sec = 0.0;
+        /// basis changes per second
+        double pivot_rate = 0.0;
+    };
+    /// returns false to stop tsimplex(..), not optimal
+    typedef std::function<bool(const progress_info&)> progress_callback;
+    /// the callback is invoked every given number of main loop iterations
+    void setProgressCallback(const progress_callback&, unsigned long every_iters = 100);
+    /// counters, histograms and timers of the main loop, logged at the end of tsimplex(..)
+    void setInstrumentation(bool);
+    /// binary trace of the main loop, one record per iteration (see itertrace.h), none if empty
+    void setTraceFile(const std::string&);
+    /// data buffers, reused by tsimplex(..) if the problem size matches
+    void setAlgData(const std::shared_ptr<tplex_alg_data>&);
+    const std::shared_ptr<tplex_alg_data>& getAlgData();
     #ifdef EXPTRACING_2
     void dump_tracing_data_to_file(std::string, std::string);
     #endif
@@ -85,9 +119,31 @@ public:
                               const std::shared_ptr<std::pair<std::vector<double>, std::vector<double>>>& coverage = nullptr,
                               bool fill_1d_sol = false, NodeArcIdType VCT = 0);
     optresult tree_minimum_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr = nullptr);
+    /// coarse-to-fine initial solution of grid instances: the 2x2 aggregated problem is solved first
+    /// and the fine vars of its optimal basis come first in the MMR order
+    optresult multiscale_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr);
+    /// entropic initial solution: log-domain Sinkhorn iterations, then the largest entries of the plan come first in the MMR order
+    optresult sinkhorn_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr);
+    /// capacitated problems: MMR within the capacities, completed by augmenting paths, then reduced to a basis by canceling
+    /// the cycles of the vars strictly between their bounds; nonbasic vars at their upper bound are listed in the var data
+    optresult capacitated_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr);
+    /// solution of a given basis tree, made primal feasible by dual simplex pivots,
+    /// 0 iterations if not primal feasible
+    optresult basis_solution(const std::shared_ptr<tplex_alg_data>& tplxd_sptr,
+                             const std::shared_ptr<SpanningTree>& bspat_sptr);
     
     /// main class methods
     optresult tsimplex(double tlim = std::numeric_limits<double>::quiet_NaN(), bool alginfolog = false, bool reptab = false);
+    /// re-optimize from the basis of the last solve after supply and demand changes, the quantities of the nodes other than
+    /// the slack node; the slack node follows the new totals and, if it changes side, appears or disappears, the problem
+    /// is solved from scratch
+    optresult updateQuantities(const std::vector<TpQuantityType>& sources, const std::vector<TpQuantityType>& destinations,
+                               double tlim = std::numeric_limits<double>::quiet_NaN(), bool alginfolog = false, bool reptab = false);
+    /// cost change (i, j, new cost)
+    typedef std::tuple<NodeArcIdType, NodeArcIdType, TpCostType> cost_change;
+    /// re-optimize from the basis of the last solve after some cost changes
+    optresult updateCosts(const std::vector<cost_change>& changes,
+                          double tlim = std::numeric_limits<double>::quiet_NaN(), bool alginfolog = false, bool reptab = false);
     
 private:
     struct algo_config
@@ -104,12 +160,53 @@ private:
         
         double partition_factor = 0.25;
         
+        unsigned int threads = 1;
+        
+        /// ctor arguments, for the solver of the coarse problem of the multiscale rule
+        unsigned long long mode = 0;
+        unsigned long long wsf = 10;
+        unsigned long long ws2f = 10;
+        double pf = 0.25;
+        
         /// substitute values
         unsigned long long max_shield_neigh_macroiter = (std::numeric_limits<unsigned long long>::max)();
     };
     
     /// private method declarations
     void initVarData(tplex_alg_data::var_data& vdata);
+    void initRowMinCosts(tplex_alg_data::var_data& vdata);
+    void initRowSortedCosts(tplex_alg_data::var_data& vdata);
+    void sortRowCosts(tplex_alg_data::var_data& vdata, NodeArcIdType i);
+    /// the costs of row i are [rowArcBegin(i), rowArcBegin(i + 1)) of the cost storage: the lanes or, if sparse, the arcs,
+    /// and the slack lanes [slackRowBegin(i), slackRowBegin(i + 1)) of an unbalanced problem, see TpCostMatrix
+    inline std::size_t rowArcBegin(NodeArcIdType i) const
+    {
+        return tpdata_sptr->costs.isDirect() ? std::size_t(tpdata_sptr->n) * i : tpdata_sptr->costs.rowBegin(i);
+    }
+    inline NodeArcIdType arcDestination(NodeArcIdType i, std::size_t a) const
+    {
+        return tpdata_sptr->costs.isDirect() ? a - std::size_t(tpdata_sptr->n) * i : tpdata_sptr->costs.rowDestination(i, a);
+    }
+    /// the vars of row i, stored and slack lanes, are [rowVarBegin(i), rowVarBegin(i + 1)) of the cost-sorted rows
+    inline std::size_t rowVarBegin(NodeArcIdType i) const
+    {
+        return this->rowArcBegin(i) + tpdata_sptr->costs.slackRowBegin(i);
+    }
+    /// suffix min. costs of the blocks of row i
+    void rowSuffixMinCosts(tplex_alg_data::var_data& vdata, NodeArcIdType i) const;
+    /// index of var (i, j) in the vars by rows, stored and slack lanes as in rowVarBegin, -1 if (i, j) is not a var
+    std::ptrdiff_t varIndex(NodeArcIdType i, NodeArcIdType j) const;
+    /// capacitated problems: nonbasic var (i, j) at its upper bound
+    inline bool atUpper(const tplex_alg_data::var_data& vdata, NodeArcIdType i, NodeArcIdType j) const
+    {
+        std::ptrdiff_t k = tpdata_sptr->capacities.find(i, j);
+        return k >= 0 && vdata.upper_pos[k] >= 0;
+    }
+    /// obj. f. and shipped quantity of the basis and of the vars at their upper bound
+    std::pair<double, double> solutionObjF(const std::shared_ptr<tplex_alg_data>& tplxd_sptr, const std::shared_ptr<SpanningTree>& bspat_sptr);
+    /// MMR taking the given vars first, then the vars in the var data order
+    optresult first_vars_min_rule(const std::shared_ptr<tplex_alg_data>& tplxd_sptr, const std::vector<CellVar>& first_vars);
+    void updateVarData(tplex_alg_data::var_data& vdata, const std::vector<cost_change>& changes);
     
     /// shielding stuff
     NodeArcIdType compute_shields_v2(const TpInstance::tcosts& costs,
@@ -122,12 +219,24 @@ private:
                                      std::vector<CellVar>& varredcsts, double shldeps = 1.0e-20);    
     
     /// compute red.costs
+    /// cost-sorted rows, early-terminating row scans
+    RCCOMPMETHOD(computeReducedCostsPol_5);
     RCCOMPMETHOD(computeReducedCostsPol_4);
     RCCOMPMETHOD(computeReducedCostsPol_3);
     /// std TP simplex 1st neg. r.c. rule
     RCCOMPMETHOD(computeReducedCostsPol_1);
     /// std TP simplex most neg. r.c. rule
     RCCOMPMETHOD(computeReducedCostsPol_0);
+    /// scans of the rules 5, 3, 1 and 0, the bounded ones (capacitated problems with vars at their upper bound)
+    /// skip the vars at their upper bound, the others are the uncapacitated scans
+    template<bool BOUNDED> RCCOMPMETHOD(reducedCostsPol_5);
+    template<bool BOUNDED> RCCOMPMETHOD(reducedCostsPol_3);
+    template<bool BOUNDED> RCCOMPMETHOD(reducedCostsPol_1);
+    template<bool BOUNDED> RCCOMPMETHOD(reducedCostsPol_0);
+    /// capacitated problems: the var at its upper bound with the largest positive r.c. enters (stored with the r.c. sign
+    /// flipped) if it beats the entering var of the pricing rule
+    void priceUpperVars(const std::vector<double>& us, const std::vector<double>& vs, const tplex_alg_data::var_data& vdata,
+                        std::vector<CellVar>& entering_vars);
     
     /// pivoting
     typedef std::tuple<unsigned long, unsigned long, unsigned long, unsigned long, double, double> pivs_data;
@@ -136,6 +245,38 @@ private:
                        std::vector<CellVar>& entering_var,
                        double& objf_value, double& tot_q,
                        bool update_rwcl_sol = false);
+    /// capacitated problems: single pivots of bounded vars, the entering var increases from 0 or decreases from its upper bound,
+    /// theta is bounded by the residual capacity of the increasing vars as well; the entering var may just flip its bound
+    pivs_data boundedPivoting(const std::shared_ptr<tplex_alg_data>& tplxd_sptr,
+                              const std::shared_ptr<SpanningTree>& bspat_sptr,
+                              std::vector<CellVar>& entering_vars,
+                              bool update_rwcl_sol = false);
+    /// dual simplex pivots restoring the primal feasibility of a dual feasible basis,
+    /// returns the number of pivots, -1 if the basis is still infeasible
+    long dualPivoting(const std::shared_ptr<tplex_alg_data>& tplxd_sptr,
+                      const std::shared_ptr<SpanningTree>& bspat_sptr);
+    /// thetas and obj. f. deltas of a loop in directions plus and minus
+    struct loop_probe
+    {
+        double minq = std::numeric_limits<double>::quiet_NaN();
+        double minq_minus = std::numeric_limits<double>::quiet_NaN();
+        double impr = 0.0;
+        double impr_minus = 0.0;
+    };
+    /// parallel loop search, vars of the batch with a false check flag are skipped
+    void findLoopsBatch(const ts_sol& quantities,
+                        const std::shared_ptr<SpanningTree>& bspat_sptr,
+                        const std::vector<CellVar>& entering_vars,
+                        std::size_t beg, std::size_t end,
+                        std::vector<Loop>& loops,
+                        std::vector<loop_probe>& probes,
+                        bool probe_dirs,
+                        const std::vector<bool>* checked = nullptr);
+    void probeLoop(const ts_sol& quantities, Loop& loop, loop_probe& probe);
+    bool isLoopStamped(const Loop& loop);
+    void stampLoop(const Loop& loop);
+    /// cancel flag set or time limit passed, polled by the main loop and by long pricing scans
+    bool stopRequested();
     
     /// problem data
     std::shared_ptr<TpInstance::TProblemData> tpdata_sptr;
@@ -150,6 +291,22 @@ private:
     /// flags
     bool retheur = false;
     bool verbose_log = false;
+    bool warm_start = false;
+    bool resume_opt = false;
+    const std::atomic<bool>* cancel_flag = nullptr;
+    /// the last pricing scan stopped early by stopRequested()
+    bool scan_stopped = false;
+    bool instr_on = false;
+    std::string trace_fname;
+    /// instrumentation stats of the running tsimplex(..), nullptr if disabled
+    Instr::stats* instr = nullptr;
+    /// reduced costs computed by the last pricing
+    unsigned long long scan_cells = 0;
+    /// pivots with theta 0 of the last pivoting(..)
+    unsigned long deg_pivots = 0;
+    progress_callback progress_cb;
+    unsigned long progress_every = 100;
+    std::chrono::steady_clock::time_point deadline = (std::chrono::steady_clock::time_point::max)();
     /// doubles
     double iter_objfv = std::numeric_limits<double>::quiet_NaN();
     std::vector<double> objf_improvs;
@@ -157,6 +314,9 @@ private:
     /// integers
     unsigned long alg_super_iter;
     unsigned long alg_iter;
+    unsigned long pruned_rcs;
+    unsigned long stamp_epoch = 0;
+    std::vector<unsigned long> node_stamps;
     unsigned int impr_vec_size = 8;
     unsigned short alg_state = 1;
     
@@ -49,6 +49,17 @@ namespace TSimplexData
             std::vector<double> cs;
             std::vector<NodeArcIdType> is;
             std::vector<NodeArcIdType> js;
+            /// vars in [0, sorted_upto) are sorted by cost and no var after them costs less
+            NodeArcIdType sorted_upto = 0;
+            /// position in cs of each var, by var index (see TSimplex::varIndex), built by the first cost update
+            std::vector<NodeArcIdType> cs_pos;
+            /// dual-bound pruning: row i has blocks [row_sufbeg[i], row_sufbeg[i + 1]) of ROWSUFBLK stored costs,
+            /// row_sufminc of a block is the min. cost from its first var to the end of the row (first block: row min.)
+            std::vector<std::size_t> row_sufbeg;
+            std::vector<double> row_sufminc;
+            /// row-major costs and columns, each row sorted by ascending cost
+            std::vector<double> row_cs;
+            std::vector<NodeArcIdType> row_js;
             
             Shielding::THEgrid board;
             std::vector<std::vector<NodeArcIdType>> supp;
@@ -69,6 +80,29 @@ namespace TSimplexData
             std::vector<bool> rotor_flags;
             std::vector<bool> rcneg_flags;
             std::vector<bool> row_flags;
+            /// capacitated problems: nonbasic vars at their upper bound, positions of TpCapacities,
+            /// upper_pos[k] is the position of k in upper, -1 if k is basic or at 0
+            std::vector<NodeArcIdType> upper;
+            std::vector<NodeArcIdTypeSGND> upper_pos;
+            
+            inline void setUpper(NodeArcIdType k, bool at_upper)
+            {
+                if(at_upper && upper_pos[k] < 0)
+                {
+                    upper_pos[k] = upper.size();
+                    upper.push_back(k);
+                }
+                else if(!at_upper && upper_pos[k] >= 0)
+                {
+                    upper_pos[upper.back()] = upper_pos[k];
+                    upper[upper_pos[k]] = upper.back();
+                    upper.pop_back();
+                    upper_pos[k] = -1;
+                }
+            }
+            
+            /// clear data keeping allocated memory
+            void clear();
         };
         /// struct attribute
         /// algorithm utility
@@ -79,6 +113,10 @@ namespace TSimplexData
         std::vector<std::vector<CellVar>> rows;
         /// solution by cols
         std::vector<std::vector<CellVar>> cols;
+        /// cross positions of the basis by rows and cols, see indexRowsCols(): rows[i][p] is cols[j][rows_cpos[i][p]]
+        /// and cols[j][p] is rows[i][cols_rpos[j][p]]
+        std::vector<std::vector<NodeArcIdType>> rows_cpos;
+        std::vector<std::vector<NodeArcIdType>> cols_rpos;
         
         ts_sol quantities;
         std::vector<double> sources;
@@ -95,7 +133,9 @@ namespace TSimplexData
         void sort();
         void addVar(CellVar& env, double c);
         void delVar(CellVar& exv);
+        void indexRowsCols();
         void clearSol();
+        void reset();
         std::string toStringSol();
     };
 }
@@ -18,6 +18,9 @@
 #ifndef TSIMPLEXSOL_H
 #define TSIMPLEXSOL_H
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "TpInstance.h"
 
 namespace TSimplexData
@@ -92,6 +95,11 @@ namespace TSimplexData
             this->erase(e);
         }
         
+        inline void reset()
+        {
+            this->clear();
+        }
+        
     private:
         NodeArcIdType MN = 0;
     };
@@ -127,6 +135,11 @@ namespace TSimplexData
         {
             std::vector<double>::operator[](e) = std::numeric_limits<double>::quiet_NaN();
         }
+        
+        inline void reset()
+        {
+            std::fill(this->begin(), this->end(), std::numeric_limits<double>::quiet_NaN());
+        }
     };
     #ifdef TSSOLSPRS
     typedef class tsimplex_sparse_sol ts_sol;
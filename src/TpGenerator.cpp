@@ -0,0 +1,595 @@
+///
+/// src/instance/TpGenerator.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <stdexcept>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <functional>
+#include <numeric>
+
+#include "TpGenerator.h"
+#include "MyLog.h"
+#include "util.h"
+
+/// cells per row block of a streamed file
+#define GENBLOCKCELLS (1 << 22)
+/// streams of the quantities, cost row i is stream i
+#define GENSTREAMSRC (1ULL << 62)
+#define GENSTREAMDST ((1ULL << 62) + 1)
+/// streams of the points and of the cluster sites
+#define GENSTREAMSRCPT ((1ULL << 62) + 2)
+#define GENSTREAMDSTPT ((1ULL << 62) + 3)
+#define GENSTREAMSITE ((1ULL << 62) + 4)
+/// forbidden lanes of row i are stream GENSTREAMFORB + i
+#define GENSTREAMFORB (1ULL << 61)
+/// capacitated lanes of row i are stream GENSTREAMCAP + i, the draws 2j (capacitated or not) and 2j + 1 (capacity)
+#define GENSTREAMCAP (1ULL << 60)
+
+#define GETOPTTMS(start) double((std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()) / 1000.0)
+
+
+TpGenerator::TpGenerator(const params& p, unsigned int thrds)
+    : prms(p), threads(thrds > 0 ? thrds : std::max(1u, std::thread::hardware_concurrency()))
+{
+    if(prms.m == 0 || prms.n == 0)
+        throw std::invalid_argument("Instance must have at least one source and one destination");
+    if(prms.ap && prms.m != prms.n)
+        throw std::invalid_argument("For AP M must equal N");
+    if(prms.minq > prms.maxq || prms.minc > prms.maxc || prms.minc < 0.0)
+        throw std::invalid_argument("Bad quantity or cost range");
+    if(prms.costs == Costs::Uniform && prms.maxc - prms.minc + 1.0 > 4294967296.0)
+        throw std::invalid_argument("Cost range too large, max. 2^32 values");
+    if(prms.side == 0 || prms.clusters == 0)
+        throw std::invalid_argument("Bad point side or number of clusters");
+    if(prms.forbidden < 0.0 || prms.forbidden >= 1.0)
+        throw std::invalid_argument("Fraction of forbidden lanes must be in [0, 1)");
+    if(prms.capacitated < 0.0 || prms.capacitated >= 1.0)
+        throw std::invalid_argument("Fraction of capacitated lanes must be in [0, 1)");
+    if(prms.surplus <= -1.0 || (prms.ap && prms.surplus != 0.0))
+        throw std::invalid_argument("Surplus must be greater than -1, 0 for AP");
+    if(prms.costs != Costs::Uniform && prms.points == Points::Grid)
+    {
+        NodeArcIdType g = std::llround(std::sqrt(prms.m));
+        if(prms.m != prms.n || g * g != prms.m)
+            throw std::invalid_argument("Grid points need m = n = g * g");
+    }
+
+    this->initPoints();
+    if(prms.forbidden > 0.0 || prms.capacitated > 0.0)
+        this->initForbidden();
+}
+
+TpGenerator::~TpGenerator()
+{
+}
+
+void TpGenerator::setFamily(const std::string& family, params& p)
+{
+    p.points = Points::Random;
+    if(family == "uniform")
+        p.costs = Costs::Uniform;
+    else if(family == "euclid")
+        p.costs = Costs::Euclid;
+    else if(family == "sqeuclid")
+        p.costs = Costs::SqEuclid;
+    else if(family == "grid")
+    {
+        p.costs = Costs::SqEuclid;
+        p.points = Points::Grid;
+    }
+    else if(family == "clustered")
+    {
+        p.costs = Costs::Euclid;
+        p.points = Points::Clustered;
+    }
+    else if(family == "forbidden")
+    {
+        p.costs = Costs::Uniform;
+        p.forbidden = p.forbidden > 0.0 ? p.forbidden : 0.2;
+    }
+    else if(family == "sparse")
+    {
+        p.costs = Costs::Uniform;
+        p.forbidden = p.forbidden > 0.0 ? p.forbidden : 0.9;
+        p.sparse = true;
+    }
+    else if(family == "capacitated")
+    {
+        p.costs = Costs::Uniform;
+        p.capacitated = p.capacitated > 0.0 ? p.capacitated : 0.3;
+    }
+    else
+        throw std::invalid_argument("Unknown instance family '" + family + "'");
+}
+
+std::string TpGenerator::familyTag(const params& p)
+{
+    std::stringstream ss;
+    ss << (p.costs == Costs::Uniform ? "uniform" : p.costs == Costs::Euclid ? "euclid" : "sqeuclid");
+    if(p.costs != Costs::Uniform && p.points == Points::Grid)
+        ss << "_grid";
+    else if(p.costs != Costs::Uniform && p.points == Points::Clustered)
+        ss << "_clustered" << p.clusters;
+    if(p.forbidden > 0.0)
+        ss << "_f" << p.forbidden;
+    if(p.sparse)
+        ss << "_sparse";
+    if(p.surplus != 0.0)
+        ss << "_s" << p.surplus;
+    if(p.capacitated > 0.0)
+        ss << "_c" << p.capacitated;
+    return ss.str();
+}
+
+void TpGenerator::initPoints()
+{
+    max_coord = 0;
+    if(prms.costs == Costs::Uniform)
+        return;
+
+    NodeArcIdType M = prms.m;
+    NodeArcIdType N = prms.n;
+    src_pts.resize(M);
+    dst_pts.resize(N);
+    if(prms.points == Points::Grid)
+    {
+        /// the grid of TProblemData::setGridCosts(), scaled to the side
+        NodeArcIdType g = std::llround(std::sqrt(M));
+        int64_t step = std::max<int64_t>(1, prms.side / g);
+        for(NodeArcIdType i = 0; i < M; i++)
+            src_pts[i] = dst_pts[i] = {int64_t(i / g) * step, int64_t(i % g) * step};
+        max_coord = int64_t(g - 1) * step;
+        return;
+    }
+
+    uint64_t src_key = this->streamKey(GENSTREAMSRCPT);
+    uint64_t dst_key = this->streamKey(GENSTREAMDSTPT);
+    if(prms.points == Points::Clustered)
+    {
+        /// sources uniform in a square of half side r around a random site
+        uint64_t site_key = this->streamKey(GENSTREAMSITE);
+        int64_t r = std::max<int64_t>(1, std::llround(prms.side / (4.0 * std::sqrt(prms.clusters))));
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(NodeArcIdTypeSGND i = 0; i < (NodeArcIdTypeSGND)M; i++)
+        {
+            uint64_t k = draw(src_key, 3 * i, 0, prms.clusters);
+            int64_t x = draw(site_key, 2 * k, 0, prms.side) + draw(src_key, 3 * i + 1, 0, 2 * r + 1) - r;
+            int64_t y = draw(site_key, 2 * k + 1, 0, prms.side) + draw(src_key, 3 * i + 2, 0, 2 * r + 1) - r;
+            src_pts[i] = {std::min<int64_t>(std::max<int64_t>(x, 0), prms.side - 1),
+                          std::min<int64_t>(std::max<int64_t>(y, 0), prms.side - 1)};
+        }
+    }
+    else
+    {
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(NodeArcIdTypeSGND i = 0; i < (NodeArcIdTypeSGND)M; i++)
+            src_pts[i] = {(int64_t)draw(src_key, 2 * i, 0, prms.side), (int64_t)draw(src_key, 2 * i + 1, 0, prms.side)};
+    }
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for(NodeArcIdTypeSGND j = 0; j < (NodeArcIdTypeSGND)N; j++)
+        dst_pts[j] = {(int64_t)draw(dst_key, 2 * j, 0, prms.side), (int64_t)draw(dst_key, 2 * j + 1, 0, prms.side)};
+    max_coord = prms.side - 1;
+}
+
+void TpGenerator::initForbidden()
+{
+    NodeArcIdType M = prms.m;
+    NodeArcIdType N = prms.n;
+    std::vector<TpQuantityType> sources;
+    std::vector<TpQuantityType> destinations;
+    this->quantities(sources, destinations);
+
+    /// north-west corner rule: the lanes of its solution keep every instance feasible
+    nwc_beg.assign(M, N - 1);
+    nwc_end.assign(M, N - 1);
+    nwc_beg[0] = 0;
+    NodeArcIdType i = 0;
+    NodeArcIdType j = 0;
+    TpQuantityType s = sources[0];
+    TpQuantityType d = destinations[0];
+    while(i < M && j < N)
+    {
+        nwc_end[i] = j;
+        bool next_row = s <= d;
+        bool next_col = d <= s;
+        if(s < d)
+            d -= s;
+        else if(d < s)
+            s -= d;
+        if(next_col && ++j < N)
+            d = destinations[j];
+        if(next_row && ++i < M)
+        {
+            s = sources[i];
+            nwc_beg[i] = std::min(j, N - 1);
+        }
+    }
+
+    /// integer quantities: a solution on a forbidden lane costs at least forbidden_cost,
+    /// more than any solution on the allowed ones
+    double max_cost = prms.costs == Costs::Uniform ? prms.maxc
+                    : prms.costs == Costs::Euclid ? std::ceil(std::sqrt(2.0) * max_coord)
+                    : 2.0 * double(max_coord) * double(max_coord);
+    double tot_q = std::max(std::accumulate(sources.begin(), sources.end(), 0.0),
+                            std::accumulate(destinations.begin(), destinations.end(), 0.0));
+    forbidden_cost = max_cost * tot_q + 1.0;
+}
+
+void TpGenerator::quantities(std::vector<TpQuantityType>& sources, std::vector<TpQuantityType>& destinations)
+{
+    NodeArcIdType M = prms.m;
+    NodeArcIdType N = prms.n;
+    sources.resize(M);
+    destinations.resize(N);
+    if(prms.ap)
+    {
+        std::fill(sources.begin(), sources.end(), 1.0);
+        std::fill(destinations.begin(), destinations.end(), 1.0);
+        return;
+    }
+
+    /// the smaller side gets larger quantities, as in TpInstance::generateData(..)
+    uint64_t src_cf = std::max<uint64_t>(1, (N + M - 1) / M);
+    uint64_t dst_cf = std::max<uint64_t>(1, (M + N - 1) / N);
+    uint64_t src_key = this->streamKey(GENSTREAMSRC);
+    uint64_t dst_key = this->streamKey(GENSTREAMDST);
+    unsigned long long tot_src = 0;
+    unsigned long long tot_dst = 0;
+    for(NodeArcIdType i = 0; i < M; i++)
+        tot_src += (sources[i] = draw(src_key, i, prms.minq, prms.maxq * src_cf - prms.minq + 1));
+    for(NodeArcIdType j = 0; j < N; j++)
+        tot_dst += (destinations[j] = draw(dst_key, j, prms.minq, prms.maxq * dst_cf - prms.minq + 1));
+
+    /// balance in closed form: the deficit is spread evenly over the smaller side, the first ones take the remainder
+    std::vector<TpQuantityType>& qs = tot_src < tot_dst ? sources : destinations;
+    unsigned long long diff = tot_src < tot_dst ? tot_dst - tot_src : tot_src - tot_dst;
+    unsigned long long each = diff / qs.size();
+    unsigned long long rem = diff % qs.size();
+    for(NodeArcIdType k = 0; k < qs.size(); k++)
+        qs[k] += each + (k < rem ? 1 : 0);
+
+    /// surplus of the sources or of the destinations, spread the same way
+    if(prms.surplus != 0.0)
+    {
+        std::vector<TpQuantityType>& sqs = prms.surplus > 0.0 ? sources : destinations;
+        unsigned long long tot = std::max(tot_src, tot_dst);
+        unsigned long long extra = std::llround(std::abs(prms.surplus) * tot);
+        each = extra / sqs.size();
+        rem = extra % sqs.size();
+        for(NodeArcIdType k = 0; k < sqs.size(); k++)
+            sqs[k] += each + (k < rem ? 1 : 0);
+    }
+}
+
+void TpGenerator::costRows(NodeArcIdType beg, NodeArcIdType end, TpCostType* buf)
+{
+    NodeArcIdType N = prms.n;
+    uint64_t lo = (uint64_t)prms.minc;
+    uint64_t range = (uint64_t)prms.maxc - lo + 1;
+    /// a lane is forbidden if its draw in [0, 2^32) is below the threshold
+    uint64_t fthr = (uint64_t)(prms.forbidden * 4294967296.0);
+
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for(NodeArcIdTypeSGND i = beg; i < (NodeArcIdTypeSGND)end; i++)
+    {
+        TpCostType* row = buf + N * (i - beg);
+        if(prms.costs == Costs::Uniform)
+        {
+            uint64_t key = this->streamKey(i);
+            for(NodeArcIdType j = 0; j < N; j++)
+                row[j] = (TpCostType)draw(key, j, lo, range);
+        }
+        else
+        {
+            const point& p = src_pts[i];
+            for(NodeArcIdType j = 0; j < N; j++)
+            {
+                int64_t dx = p.x - dst_pts[j].x;
+                int64_t dy = p.y - dst_pts[j].y;
+                double d2 = double(dx * dx + dy * dy);
+                row[j] = prms.costs == Costs::SqEuclid ? d2 : std::round(std::sqrt(d2));
+            }
+        }
+        if(fthr > 0)
+        {
+            uint64_t fkey = this->streamKey(GENSTREAMFORB + i);
+            for(NodeArcIdType j = 0; j < N; j++)
+                if((j < nwc_beg[i] || j > nwc_end[i]) && draw(fkey, j, 0, 1ULL << 32) < fthr)
+                    row[j] = forbidden_cost;
+        }
+    }
+}
+
+std::shared_ptr<TpInstance::TProblemData> TpGenerator::generate()
+{
+    FILE_LOG(logINFO) << "Generate instance " << prms.m << "x" << prms.n << " " << familyTag(prms) << " with random seed " << prms.seed << " ::: threads >> " << threads;
+    auto start = std::chrono::steady_clock::now();
+
+    std::shared_ptr<TpInstance::TProblemData> tpdata_sptr(new TpInstance::TProblemData());
+    tpdata_sptr->m = prms.m;
+    tpdata_sptr->n = prms.n;
+    tpdata_sptr->rndseed = prms.seed;
+    tpdata_sptr->reduced = false;
+    this->quantities(tpdata_sptr->sources, tpdata_sptr->destinations);
+    tpdata_sptr->computeQuantityStats();
+    /// pvars are built lazily by the solver
+    if(prms.sparse)
+    {
+        /// arcs of the allowed lanes, block of rows by block of rows
+        std::vector<NodeArcIdType> is;
+        std::vector<NodeArcIdType> js;
+        std::vector<TpCostType> cs;
+        this->forEachArc([&](NodeArcIdType i, NodeArcIdType j, TpCostType c)
+        {
+            is.push_back(i);
+            js.push_back(j);
+            cs.push_back(c);
+        });
+        tpdata_sptr->setSparseCosts(is, js, cs);
+    }
+    else
+    {
+        tpdata_sptr->costs.resize(prms.m * prms.n);
+        this->costRows(0, prms.m, tpdata_sptr->costs.data());
+        tpdata_sptr->computeCostStats();
+    }
+    if(prms.capacitated > 0.0)
+    {
+        std::vector<NodeArcIdType> is;
+        std::vector<NodeArcIdType> js;
+        std::vector<TpQuantityType> us;
+        this->forEachCapacity([&](NodeArcIdType i, NodeArcIdType j, TpQuantityType u)
+        {
+            is.push_back(i);
+            js.push_back(j);
+            us.push_back(u);
+        });
+        tpdata_sptr->setCapacities(is, js, us);
+    }
+    tpdata_sptr->name = std::string(prms.ap ? "ap" : "tp") +
+                        "_" + std::to_string(prms.minq) +
+                        "_" + std::to_string(prms.maxq) +
+                        "_" + std::to_string((long long)prms.minc) +
+                        "_" + std::to_string((long long)prms.maxc) +
+                        "_" + std::to_string(prms.m) +
+                        "_" + std::to_string(prms.n) +
+                        "_" + std::to_string(prms.seed);
+    std::string tag = familyTag(prms);
+    if(tag != "uniform")
+        tpdata_sptr->name += "_" + tag;
+
+    FILE_LOG(logINFO) << "Instance generation time = " << GETOPTTMS(start) << " [ms]";
+
+    return tpdata_sptr;
+}
+
+void TpGenerator::forEachArc(const std::function<void(NodeArcIdType, NodeArcIdType, TpCostType)>& f)
+{
+    NodeArcIdType M = prms.m;
+    NodeArcIdType N = prms.n;
+    NodeArcIdType brows = this->blockRows();
+    std::vector<TpCostType> buf(brows * N);
+    for(NodeArcIdType beg = 0; beg < M; beg += brows)
+    {
+        NodeArcIdType end = std::min(M, beg + brows);
+        this->costRows(beg, end, buf.data());
+        for(NodeArcIdType r = 0; r < end - beg; r++)
+            for(NodeArcIdType j = 0; j < N; j++)
+                if(!(prms.forbidden > 0.0 && buf[N * r + j] == forbidden_cost))
+                    f(beg + r, j, buf[N * r + j]);
+    }
+}
+
+void TpGenerator::forEachCapacity(const std::function<void(NodeArcIdType, NodeArcIdType, TpQuantityType)>& f)
+{
+    /// forbidden lanes are not capacitated, see costRows(..)
+    uint64_t fthr = (uint64_t)(prms.forbidden * 4294967296.0);
+    uint64_t cthr = (uint64_t)(prms.capacitated * 4294967296.0);
+    for(NodeArcIdType i = 0; i < prms.m; i++)
+    {
+        uint64_t fkey = this->streamKey(GENSTREAMFORB + i);
+        uint64_t ckey = this->streamKey(GENSTREAMCAP + i);
+        for(NodeArcIdType j = 0; j < prms.n; j++)
+        {
+            if(!(j < nwc_beg[i] || j > nwc_end[i]) || draw(ckey, 2 * j, 0, 1ULL << 32) >= cthr)
+                continue;
+            if(fthr > 0 && draw(fkey, j, 0, 1ULL << 32) < fthr)
+                continue;
+            f(i, j, (TpQuantityType)draw(ckey, 2 * j + 1, 0, prms.maxq + 1));
+        }
+    }
+}
+
+NodeArcIdType TpGenerator::blockRows() const
+{
+    return std::max<NodeArcIdType>(threads, std::min<NodeArcIdType>(prms.m, GENBLOCKCELLS / prms.n));
+}
+
+/// decimal digits of v appended to s
+static inline void append_uint(std::string& s, unsigned long long v)
+{
+    char buf[24];
+    char* p = buf + sizeof(buf);
+    do
+    {
+        *--p = char('0' + v % 10);
+        v /= 10;
+    }
+    while(v);
+    s.append(p, buf + sizeof(buf) - p);
+}
+
+void TpGenerator::writeCapacities(std::ofstream& ofs)
+{
+    unsigned long long caps = 0;
+    this->forEachCapacity([&](NodeArcIdType, NodeArcIdType, TpQuantityType) { ++caps; });
+    
+    std::string s(TPCAPACITYTAG);
+    s += ' ';
+    append_uint(s, caps); s += '\n';
+    this->forEachCapacity([&](NodeArcIdType i, NodeArcIdType j, TpQuantityType u)
+    {
+        append_uint(s, i); s += ' ';
+        append_uint(s, j); s += ' ';
+        append_uint(s, (unsigned long long)u); s += '\n';
+        if(s.size() >= GENBLOCKCELLS)
+        {
+            ofs.write(s.data(), s.size());
+            s.clear();
+        }
+    });
+    ofs.write(s.data(), s.size());
+}
+
+void TpGenerator::write(const std::string& fname, bool binary)
+{
+    if(binary && prms.sparse)
+        throw std::invalid_argument("Sparse instances are written as text files only");
+    if(binary && prms.capacitated > 0.0)
+        throw std::invalid_argument("Capacitated instances are written as text files only");
+    std::ofstream ofs(fname, std::ios::binary);
+    if(!ofs)
+        throw std::runtime_error("File creation fails");
+
+    FILE_LOG(logINFO) << "Write instance " << prms.m << "x" << prms.n << " " << familyTag(prms) << " with random seed " << prms.seed
+                      << " to " << fname << (binary ? " (binary)" : " (text)") << " ::: threads >> " << threads;
+    auto start = std::chrono::steady_clock::now();
+
+    NodeArcIdType M = prms.m;
+    NodeArcIdType N = prms.n;
+    std::vector<TpQuantityType> sources;
+    std::vector<TpQuantityType> destinations;
+    this->quantities(sources, destinations);
+
+    /// sparse instance: arcs are counted first, then written
+    if(prms.sparse)
+    {
+        unsigned long long arcs = 0;
+        this->forEachArc([&](NodeArcIdType, NodeArcIdType, TpCostType) { ++arcs; });
+        
+        std::string s(TPSPARSETAG);
+        s += ' ';
+        append_uint(s, M); s += ' ';
+        append_uint(s, N); s += ' ';
+        append_uint(s, arcs); s += '\n';
+        for(NodeArcIdType i = 0; i < M; i++)
+        {
+            append_uint(s, (unsigned long long)sources[i]);
+            s += i + 1 < M ? ' ' : '\n';
+        }
+        for(NodeArcIdType j = 0; j < N; j++)
+        {
+            append_uint(s, (unsigned long long)destinations[j]);
+            s += j + 1 < N ? ' ' : '\n';
+        }
+        ofs.write(s.data(), s.size());
+        
+        s.clear();
+        this->forEachArc([&](NodeArcIdType i, NodeArcIdType j, TpCostType c)
+        {
+            append_uint(s, i); s += ' ';
+            append_uint(s, j); s += ' ';
+            append_uint(s, (unsigned long long)c); s += '\n';
+            if(s.size() >= GENBLOCKCELLS)
+            {
+                ofs.write(s.data(), s.size());
+                s.clear();
+            }
+        });
+        ofs.write(s.data(), s.size());
+        if(prms.capacitated > 0.0)
+            this->writeCapacities(ofs);
+        if(!ofs)
+            throw std::runtime_error("File write fails");
+        ofs.close();
+        
+        FILE_LOG(logINFO) << "Instance writing time = " << GETOPTTMS(start) << " [ms] ::: arcs >> " << arcs;
+        return;
+    }
+    
+    /// header and quantities
+    if(binary)
+    {
+        uint64_t hdr[3] = {(uint64_t)M, (uint64_t)N, (uint64_t)prms.seed};
+        ofs.write(TPBINMAGIC, sizeof(TPBINMAGIC));
+        ofs.write(reinterpret_cast<const char*>(hdr), sizeof(hdr));
+        ofs.write(reinterpret_cast<const char*>(sources.data()), M * sizeof(TpQuantityType));
+        ofs.write(reinterpret_cast<const char*>(destinations.data()), N * sizeof(TpQuantityType));
+    }
+    else
+    {
+        std::string s;
+        append_uint(s, M); s += ' ';
+        append_uint(s, N); s += ' ';
+        append_uint(s, prms.seed); s += '\n';
+        for(NodeArcIdType i = 0; i < M; i++)
+        {
+            append_uint(s, (unsigned long long)sources[i]);
+            s += i + 1 < M ? ' ' : '\n';
+        }
+        for(NodeArcIdType j = 0; j < N; j++)
+        {
+            append_uint(s, (unsigned long long)destinations[j]);
+            s += j + 1 < N ? ' ' : '\n';
+        }
+        ofs.write(s.data(), s.size());
+    }
+
+    /// costs, one block of rows at a time
+    NodeArcIdType brows = this->blockRows();
+    std::vector<TpCostType> buf(brows * N);
+    std::vector<std::string> lines(binary ? 0 : brows);
+    for(NodeArcIdType beg = 0; beg < M; beg += brows)
+    {
+        NodeArcIdType end = std::min(M, beg + brows);
+        this->costRows(beg, end, buf.data());
+        if(binary)
+        {
+            ofs.write(reinterpret_cast<const char*>(buf.data()), (end - beg) * N * sizeof(TpCostType));
+        }
+        else
+        {
+            /// rows are formatted in parallel, then written in order
+            #pragma omp parallel for schedule(static) num_threads(threads)
+            for(NodeArcIdTypeSGND r = 0; r < (NodeArcIdTypeSGND)(end - beg); r++)
+            {
+                std::string& line = lines[r];
+                line.clear();
+                const TpCostType* row = buf.data() + N * r;
+                for(NodeArcIdType j = 0; j < N; j++)
+                {
+                    append_uint(line, (unsigned long long)row[j]);
+                    line += j + 1 < N ? ' ' : '\n';
+                }
+            }
+            for(NodeArcIdType r = 0; r < end - beg; r++)
+                ofs.write(lines[r].data(), lines[r].size());
+        }
+        if(!ofs)
+            throw std::runtime_error("File write fails");
+    }
+    if(prms.capacitated > 0.0)
+        this->writeCapacities(ofs);
+    if(!ofs)
+        throw std::runtime_error("File write fails");
+    ofs.close();
+
+    FILE_LOG(logINFO) << "Instance writing time = " << GETOPTTMS(start) << " [ms]";
+}
@@ -0,0 +1,148 @@
+///
+/// src/instance/TpGenerator.h
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef TPGENERATOR_H
+#define TPGENERATOR_H
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TpInstance.h"
+
+///
+/// Random instance generator for large scaling tests
+///
+/// Every value is a function of the seed, of its stream (a cost row, the supplies or the demands)
+/// and of its position in the stream (counter-based RNG), so rows are generated in parallel and
+/// the instance does not depend on the number of threads
+/// Supplies and demands are balanced in closed form, then unbalanced by a surplus if any
+/// Costs are uniform integers or the (rounded) Euclidean or squared Euclidean distances between
+/// points of the plane, random, clustered or on a grid; lanes can be forbidden (see forbidden) or capacitated
+/// Instances are built in memory or streamed to a file, row block by row block
+///
+class TpGenerator
+{
+public:
+    enum class Costs { Uniform, Euclid, SqEuclid };
+    enum class Points { Random, Grid, Clustered };
+
+    struct params
+    {
+        /// assignment problem, m = n and unit quantities
+        bool ap = false;
+        unsigned int minq = 1;
+        unsigned int maxq = 100;
+        /// range of uniform costs
+        double minc = 1.0;
+        double maxc = 1000.0;
+        NodeArcIdType m = 0;
+        NodeArcIdType n = 0;
+        unsigned long long seed = 1;
+        Costs costs = Costs::Uniform;
+        /// points of geometric costs, integer coordinates in [0, side)
+        /// Grid: sources and destinations on the same sqrt(m) x sqrt(m) grid, m = n (shielding applies to SqEuclid)
+        /// Clustered: sources around clusters random sites, destinations uniform
+        Points points = Points::Random;
+        unsigned int clusters = 8;
+        unsigned int side = 1000;
+        /// fraction of forbidden lanes, with a cost no optimal solution can afford (the cost of
+        /// any solution on allowed lanes is lower), the lanes of the north-west corner solution stay allowed
+        double forbidden = 0.0;
+        /// sparse instance of the allowed lanes only (see TpInstance.h), text files only
+        bool sparse = false;
+        /// unbalanced instance: the supply exceeds (> 0) or falls short of (< 0) the demand by this fraction of it
+        double surplus = 0.0;
+        /// fraction of capacitated lanes, capacities uniform in [0, maxq], the lanes of the north-west corner
+        /// solution stay uncapacitated (the instance is feasible), text files only
+        double capacitated = 0.0;
+    };
+
+    /// 0 threads means all the hardware threads
+    TpGenerator(const params&, unsigned int threads = 0);
+    ~TpGenerator();
+
+    /// named family: uniform, euclid, sqeuclid, grid (sqeuclid on a grid), clustered (euclid), forbidden (uniform, 20% forbidden),
+    /// sparse (uniform, 10% of the lanes are arcs), capacitated (uniform, 30% of the lanes capacitated)
+    static void setFamily(const std::string& family, params&);
+    /// e.g., euclid_clustered8_f0.2
+    static std::string familyTag(const params&);
+
+    /// balanced supplies and demands, but for the surplus
+    void quantities(std::vector<TpQuantityType>& sources, std::vector<TpQuantityType>& destinations);
+    /// costs of the rows [beg, end), row-major
+    void costRows(NodeArcIdType beg, NodeArcIdType end, TpCostType* buf);
+
+    /// in-memory instance
+    std::shared_ptr<TpInstance::TProblemData> generate();
+    /// instance file, text (the format of TpInstance) or binary (see TpInstance), the cost matrix is never in memory
+    void write(const std::string& fname, bool binary = false);
+
+private:
+    /// counter-based RNG: a SplitMix64 finalizer of (stream key, counter)
+    static inline uint64_t mix64(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+    inline uint64_t streamKey(uint64_t stream) const
+    {
+        return mix64(prms.seed * 0x9E3779B97F4A7C15ULL + mix64(stream + 1));
+    }
+    /// uniform integer in [lo, lo + range), range < 2^32
+    static inline uint64_t draw(uint64_t key, uint64_t ctr, uint64_t lo, uint64_t range)
+    {
+        return lo + (((mix64(key + ctr * 0x9E3779B97F4A7C15ULL) >> 32) * range) >> 32);
+    }
+
+    /// rows per block of a streamed file
+    NodeArcIdType blockRows() const;
+    /// f(i, j, cost) for the allowed lanes, by rows
+    void forEachArc(const std::function<void(NodeArcIdType, NodeArcIdType, TpCostType)>& f);
+    /// f(i, j, capacity) for the capacitated lanes, by rows
+    void forEachCapacity(const std::function<void(NodeArcIdType, NodeArcIdType, TpQuantityType)>& f);
+    /// capacity section of a text file, see TPCAPACITYTAG
+    void writeCapacities(std::ofstream& ofs);
+    /// points of geometric costs and allowed lanes, O(m + n)
+    void initPoints();
+    void initForbidden();
+
+    struct point
+    {
+        int64_t x;
+        int64_t y;
+    };
+
+    params prms;
+    unsigned int threads;
+    std::vector<point> src_pts;
+    std::vector<point> dst_pts;
+    /// max. coordinate of the points
+    int64_t max_coord;
+    /// lanes [nwc_beg[i], nwc_end[i]] of row i are never forbidden nor capacitated
+    std::vector<NodeArcIdType> nwc_beg;
+    std::vector<NodeArcIdType> nwc_end;
+    TpCostType forbidden_cost;
+};
+
+#endif // TPGENERATOR_H
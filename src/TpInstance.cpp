@@ -23,11 +23,15 @@
 #endif
 
 #include <limits>
+#include <cmath>
 #include <fstream>
 #include <numeric>
 #include <random>
 #include <chrono>
 #include <map>
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
 
 #include "TpInstance.h"
 #include "util.h"
@@ -36,9 +40,32 @@
 #define GETOPTTMS(start) double((std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()) / 1000.0)
 
 
+const TpCostType& TpCostMatrix::laneAt(std::size_t i, std::size_t j) const
+{
+    if(slack_side == Slack::Destination && j == ncols)
+        return slack_cs[i];
+    if(slack_side == Slack::Source && i == nrows)
+        return slack_cs[j];
+    if(!is_sparse)
+        return cptr[ncols * i + j];
+    
+    /// branchless lower bound of the destination in the row, basis lookups are hot
+    std::size_t len = arc_beg[i + 1] - arc_beg[i];
+    if(len == 0)
+        return big_m;
+    const NodeArcIdType* base = arc_dst.data() + arc_beg[i];
+    while(len > 1)
+    {
+        std::size_t half = len / 2;
+        base += base[half - 1] < j ? half : 0;
+        len -= half;
+    }
+    return *base == j ? cptr[base - arc_dst.data()] : big_m;
+}
+
 TpInstance::TpInstance(std::string ifnm)
 {
-    std::ifstream ifs(ifnm);
+    std::ifstream ifs(ifnm, std::ios::binary);
     
     /// open input file
     if(!ifs.is_open())
@@ -49,6 +76,27 @@ TpInstance::TpInstance(std::string ifnm)
     unsigned long long rnds; 
     ifname = ifnm;
     tp_data_sptr.reset(new TProblemData());
+    
+    /// binary file
+    char magic[sizeof(TPBINMAGIC)];
+    if(ifs.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), TPBINMAGIC))
+    {
+        this->readBinary(ifs);
+        return;
+    }
+    ifs.clear();
+    ifs.seekg(0);
+    
+    /// sparse text file
+    std::string tag;
+    if(ifs >> tag && tag == TPSPARSETAG)
+    {
+        this->readSparse(ifs);
+        return;
+    }
+    ifs.clear();
+    ifs.seekg(0);
+    
     NodeArcIdType m;
     NodeArcIdType n;
     
@@ -102,26 +150,531 @@ TpInstance::TpInstance(std::string ifnm)
     tp_data_sptr->maxc = std::numeric_limits<double>::lowest();
     tp_data_sptr->avgc = 0.0;
     double cf = 1.0 / (m * n);
+    TpCostType* cmtx = tp_data_sptr->costs.data();
     
     for(NodeArcIdType i = 0; i < m; i++)
     {
         for(NodeArcIdType j = 0; j < n; j++)
         {
-            ifs >> tp_data_sptr->costs[n * i + j];
+            ifs >> cmtx[n * i + j];
             tp_data_sptr->pvars[n * i + j] = std::make_pair(n * i + j, tp_data_sptr->costs[n * i + j]);
             tp_data_sptr->minc = std::min(tp_data_sptr->costs[n * i + j], tp_data_sptr->minc);
             tp_data_sptr->maxc = std::max(tp_data_sptr->costs[n * i + j], tp_data_sptr->maxc);
             tp_data_sptr->avgc += tp_data_sptr->costs[n * i + j] * cf;
         }
     }
+    this->readTrailer(ifs);
     
     ifs.close();
 }
 
+bool TpInstance::readSize(std::string fname, NodeArcIdType& m, NodeArcIdType& n)
+{
+    std::ifstream ifs(fname, std::ios::binary);
+    
+    /// binary file, m and n follow the magic
+    char magic[sizeof(TPBINMAGIC)];
+    if(ifs.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), TPBINMAGIC))
+    {
+        uint64_t hdr[2];
+        if(!ifs.read(reinterpret_cast<char*>(hdr), sizeof(hdr)))
+            return false;
+        m = hdr[0];
+        n = hdr[1];
+        return true;
+    }
+    ifs.clear();
+    ifs.seekg(0);
+    
+    /// sparse text file, the tag first
+    std::string tag;
+    if(!(ifs >> tag))
+        return false;
+    if(tag != TPSPARSETAG)
+    {
+        ifs.clear();
+        ifs.seekg(0);
+    }
+    
+    return bool(ifs >> m >> n);
+}
+
+void TpInstance::readBinary(std::istream& is)
+{
+    uint64_t hdr[3];
+    if(!is.read(reinterpret_cast<char*>(hdr), sizeof(hdr)))
+        throw std::invalid_argument("Bad binary instance header");
+    NodeArcIdType m = hdr[0];
+    NodeArcIdType n = hdr[1];
+    
+    if(m == 0 || n == 0)
+        throw std::invalid_argument("Instance must have at least one source and one destination");
+    if(m * n > std::numeric_limits<NodeArcIdTypeSGND>::max())
+        throw std::invalid_argument("Instance too large, max. m*n value is " + std::to_string(std::numeric_limits<NodeArcIdTypeSGND>::max()));
+    
+    tp_data_sptr->m = m;
+    tp_data_sptr->n = n;
+    tp_data_sptr->rndseed = hdr[2];
+    tp_data_sptr->reduced = false;
+    
+    /// no pvars, the solver builds them lazily
+    tp_data_sptr->sources.resize(m);
+    tp_data_sptr->destinations.resize(n);
+    tp_data_sptr->costs.resize(m * n);
+    if(!is.read(reinterpret_cast<char*>(tp_data_sptr->sources.data()), m * sizeof(TpQuantityType))
+       || !is.read(reinterpret_cast<char*>(tp_data_sptr->destinations.data()), n * sizeof(TpQuantityType))
+       || !is.read(reinterpret_cast<char*>(tp_data_sptr->costs.data()), m * n * sizeof(TpCostType)))
+        throw std::invalid_argument("Truncated binary instance file");
+    
+    tp_data_sptr->computeQuantityStats();
+    tp_data_sptr->computeCostStats();
+}
+
+void TpInstance::readSparse(std::istream& is)
+{
+    NodeArcIdType m;
+    NodeArcIdType n;
+    NodeArcIdType arcs;
+    if(!(is >> m >> n >> arcs))
+        throw std::invalid_argument("Bad sparse instance header");
+    
+    if(m == 0 || n == 0)
+        throw std::invalid_argument("Instance must have at least one source and one destination");
+    if(m * n > std::numeric_limits<NodeArcIdTypeSGND>::max())
+        throw std::invalid_argument("Instance too large, max. m*n value is " + std::to_string(std::numeric_limits<NodeArcIdTypeSGND>::max()));
+    if(arcs > m * n)
+        throw std::invalid_argument("More arcs than lanes in sparse instance");
+    
+    tp_data_sptr->m = m;
+    tp_data_sptr->n = n;
+    tp_data_sptr->rndseed = 0;
+    tp_data_sptr->reduced = false;
+    
+    tp_data_sptr->sources.resize(m);
+    tp_data_sptr->destinations.resize(n);
+    for(NodeArcIdType i = 0; i < m; i++)
+        is >> tp_data_sptr->sources[i];
+    for(NodeArcIdType j = 0; j < n; j++)
+        is >> tp_data_sptr->destinations[j];
+    
+    std::vector<NodeArcIdType> is_(arcs);
+    std::vector<NodeArcIdType> js(arcs);
+    std::vector<TpCostType> cs(arcs);
+    for(NodeArcIdType a = 0; a < arcs; a++)
+    {
+        if(!(is >> is_[a] >> js[a] >> cs[a]))
+            throw std::invalid_argument("Truncated sparse instance file");
+        if(is_[a] >= m || js[a] >= n)
+            throw std::invalid_argument("Arc " + std::to_string(is_[a]) + " -> " + std::to_string(js[a]) + " out of range");
+    }
+    
+    tp_data_sptr->computeQuantityStats();
+    tp_data_sptr->setSparseCosts(is_, js, cs);
+    this->readTrailer(is);
+}
+
+void TpInstance::readTrailer(std::istream& is)
+{
+    std::string tag;
+    while(is >> tag)
+    {
+        if(tag == TPCAPACITYTAG)
+        {
+            NodeArcIdType k;
+            if(!(is >> k))
+                throw std::invalid_argument("Bad capacity section, expected the number of capacitated lanes");
+            std::vector<NodeArcIdType> is_(k);
+            std::vector<NodeArcIdType> js(k);
+            std::vector<TpQuantityType> us(k);
+            for(NodeArcIdType c = 0; c < k; c++)
+            {
+                if(!(is >> is_[c] >> js[c] >> us[c]))
+                    throw std::invalid_argument("Truncated capacity section");
+            }
+            tp_data_sptr->setCapacities(is_, js, us);
+        }
+        else if(tag == TPSLACKTAG)
+        {
+            TpCostType c;
+            tp_data_sptr->slack_costs.clear();
+            while(is >> c)
+                tp_data_sptr->slack_costs.push_back(c);
+            is.clear();
+        }
+        else
+            throw std::invalid_argument("Unexpected '" + tag + "' after the costs, expected '" + TPCAPACITYTAG + "' or '" + TPSLACKTAG + "'");
+    }
+}
+
+TpInstance::TpInstance(NodeArcIdType m, NodeArcIdType n, const TpQuantityType* supplies, const TpQuantityType* demands, const TpCostType* costs)
+{
+    if(m == 0 || n == 0)
+        throw std::invalid_argument("Instance must have at least one source and one destination");
+    
+    if(m * n > std::numeric_limits<NodeArcIdTypeSGND>::max())
+        throw std::invalid_argument("Instance too large, max. m*n value is " + std::to_string(std::numeric_limits<NodeArcIdTypeSGND>::max()));
+    
+    if(supplies == nullptr || demands == nullptr || costs == nullptr)
+        throw std::invalid_argument("Null instance data buffer");
+    
+    ifname = "";
+    tp_data_sptr.reset(new TProblemData());
+    tp_data_sptr->m = m;
+    tp_data_sptr->n = n;
+    tp_data_sptr->rndseed = 0;
+    tp_data_sptr->reduced = false;
+    tp_data_sptr->name = "inmemory_" + std::to_string(m) + "_" + std::to_string(n);
+    
+    /// quantities are copied, the cost matrix is not
+    tp_data_sptr->sources.assign(supplies, supplies + m);
+    tp_data_sptr->destinations.assign(demands, demands + n);
+    tp_data_sptr->costs.view(costs, m * n);
+    
+    tp_data_sptr->computeQuantityStats();
+    tp_data_sptr->computeCostStats();
+}
+
 TpInstance::~TpInstance()
 {
 }
 
+void TpInstance::TProblemData::computeQuantityStats()
+{
+    srcs_at_zero = dsts_at_zero = 0;
+    tot_src_quantity = tot_dst_quantity = 0.0;
+    for(NodeArcIdType i = 0; i < sources.size(); i++)
+    {
+        if(sources[i] < MYEPS)
+            ++srcs_at_zero;
+        tot_src_quantity += sources[i];
+    }
+    for(NodeArcIdType j = 0; j < destinations.size(); j++)
+    {
+        if(destinations[j] < MYEPS)
+            ++dsts_at_zero;
+        tot_dst_quantity += destinations[j];
+    }
+}
+
+void TpInstance::TProblemData::computeCostStats()
+{
+    double cf = 1.0 / costs.vars();
+    
+    minc = std::numeric_limits<double>::max();
+    maxc = std::numeric_limits<double>::lowest();
+    avgc = 0.0;
+    for(auto it = costs.begin(); it != costs.end(); it++)
+    {
+        minc = std::min(*it, minc);
+        maxc = std::max(*it, maxc);
+        avgc += (*it) * cf;
+    }
+    for(auto it = costs.slackCosts().begin(); it != costs.slackCosts().end(); it++)
+    {
+        minc = std::min(*it, minc);
+        maxc = std::max(*it, maxc);
+        avgc += (*it) * cf;
+    }
+}
+
+void TpInstance::TProblemData::initPVars()
+{
+    if(pvars.size() == costs.vars())
+        return;
+    
+    pvars.resize(costs.vars());
+    if(!costs.isDirect())
+    {
+        /// stored lanes (the arcs only if sparse) and slack lanes, by rows
+        const TpCostType* acs = costs.begin();
+        const TpCostType* scs = costs.slackCosts().data();
+        std::size_t v = 0;
+        for(NodeArcIdType i = 0; i < m; i++)
+        {
+            for(std::size_t a = costs.rowBegin(i); a < costs.rowBegin(i + 1); a++)
+                pvars[v++] = std::make_pair(n * i + costs.rowDestination(i, a), acs[a]);
+            for(std::size_t s = costs.slackRowBegin(i); s < costs.slackRowBegin(i + 1); s++)
+                pvars[v++] = std::make_pair(n * i + costs.slackDestination(s), scs[s]);
+        }
+        return;
+    }
+    for(NodeArcIdType c = 0; c < costs.size(); c++)
+        pvars[c] = std::make_pair(c, costs[c]);
+}
+
+bool TpInstance::TProblemData::balance()
+{
+    this->computeQuantityStats();
+    TpCostMatrix::Slack side = costs.slackSide();
+    /// supply minus demand of the nodes other than the slack node
+    double diff = tot_src_quantity - tot_dst_quantity;
+    if(side == TpCostMatrix::Slack::Source)
+        diff -= sources.back();
+    else if(side == TpCostMatrix::Slack::Destination)
+        diff += destinations.back();
+    /// slack node on the right side: new quantity, the lanes are unchanged
+    if((side == TpCostMatrix::Slack::Destination && diff > MYEPS) || (side == TpCostMatrix::Slack::Source && diff < -MYEPS))
+    {
+        (side == TpCostMatrix::Slack::Destination ? destinations.back() : sources.back()) = std::abs(diff);
+        this->computeQuantityStats();
+        return true;
+    }
+    this->unbalance();
+    if(std::abs(diff) <= MYEPS)
+        return false;
+    
+    /// excess supply to a slack destination, unmet demand from a slack source
+    bool to_dst = diff > 0.0;
+    std::vector<TpCostType> scs(slack_costs);
+    if(scs.empty())
+        scs.assign(to_dst ? m : n, 0.0);
+    if(scs.size() != (to_dst ? m : n))
+        throw std::invalid_argument(std::to_string(scs.size()) + " slack costs, expected " + std::to_string(to_dst ? m : n) +
+                                    (to_dst ? " (one per source, excess supply)" : " (one per destination, unmet demand)"));
+    
+    costs.slack(to_dst ? TpCostMatrix::Slack::Destination : TpCostMatrix::Slack::Source, m, n, scs);
+    if(to_dst)
+    {
+        destinations.push_back(diff);
+        ++n;
+    }
+    else
+    {
+        sources.push_back(-diff);
+        ++m;
+    }
+    pvars.clear();
+    this->computeQuantityStats();
+    this->computeCostStats();
+    /// big M of the missing lanes above the slack costs as well
+    if(costs.isSparse())
+        costs.setBigM(std::max(costs.bigM(), std::max(1.0, std::max(0.0, maxc) - std::min(0.0, minc)) * std::max(tot_src_quantity, tot_dst_quantity) + 1.0));
+    
+    FILE_LOG(logINFO) << "Unbalanced problem ::: slack " << (to_dst ? "destination" : "source")
+                      << " ::: " << (to_dst ? "excess supply >> " : "unmet demand >> ") << std::fixed << std::setprecision(0) << std::abs(diff);
+    
+    return true;
+}
+
+void TpInstance::TProblemData::unbalance()
+{
+    TpCostMatrix::Slack side = costs.slackSide();
+    if(side == TpCostMatrix::Slack::None)
+        return;
+    
+    if(side == TpCostMatrix::Slack::Destination)
+    {
+        destinations.pop_back();
+        --n;
+    }
+    else
+    {
+        sources.pop_back();
+        --m;
+    }
+    std::vector<TpCostType> scs;
+    costs.slack(TpCostMatrix::Slack::None, m, n, scs);
+    pvars.clear();
+    this->computeQuantityStats();
+    this->computeCostStats();
+}
+
+void TpInstance::TProblemData::setSparseCosts(const std::vector<NodeArcIdType>& is, const std::vector<NodeArcIdType>& js, const std::vector<TpCostType>& cs)
+{
+    /// counting sort by row, then by destination within rows
+    std::vector<std::size_t> beg(m + 1, 0);
+    for(auto it = is.begin(); it != is.end(); it++)
+        ++beg[*it + 1];
+    for(NodeArcIdType i = 0; i < m; i++)
+        beg[i + 1] += beg[i];
+    std::vector<std::size_t> pos(beg.begin(), beg.end() - 1);
+    std::vector<std::pair<NodeArcIdType, TpCostType>> arcs(is.size());
+    for(std::size_t a = 0; a < is.size(); a++)
+        arcs[pos[is[a]]++] = std::make_pair(js[a], cs[a]);
+    
+    std::vector<NodeArcIdType> dst(arcs.size());
+    std::vector<TpCostType> acs(arcs.size());
+    for(NodeArcIdType i = 0; i < m; i++)
+    {
+        std::sort(arcs.begin() + beg[i], arcs.begin() + beg[i + 1]);
+        for(std::size_t a = beg[i]; a < beg[i + 1]; a++)
+        {
+            if(a > beg[i] && arcs[a].first == arcs[a - 1].first)
+                throw std::invalid_argument("Duplicate arc " + std::to_string(i) + " -> " + std::to_string(arcs[a].first));
+            dst[a] = arcs[a].first;
+            acs[a] = arcs[a].second;
+        }
+    }
+    
+    /// big M: with integer quantities a solution shipping on a missing lane costs more than any solution on the arcs
+    double range = 1.0;
+    if(!acs.empty())
+    {
+        auto mm = std::minmax_element(acs.begin(), acs.end());
+        range = std::max(1.0, std::max(0.0, *mm.second) - std::min(0.0, *mm.first));
+    }
+    double bigm = range * std::max(tot_src_quantity, tot_dst_quantity) + 1.0;
+    
+    pvars.clear();
+    costs.sparse(n, beg, dst, acs, bigm);
+    this->computeCostStats();
+}
+
+void TpInstance::TProblemData::setCapacities(const std::vector<NodeArcIdType>& is, const std::vector<NodeArcIdType>& js, const std::vector<TpQuantityType>& us)
+{
+    for(std::size_t k = 0; k < js.size(); k++)
+        if(js[k] >= n)
+            throw std::invalid_argument("Capacity of lane " + std::to_string(k < is.size() ? is[k] : 0) + " -> " + std::to_string(js[k]) + " out of range");
+    capacities.set(m, is, js, us);
+}
+
+bool TpInstance::TProblemData::capacitatedFlow(const std::vector<NodeArcIdType>& is, const std::vector<NodeArcIdType>& js,
+                                               std::unordered_map<NodeArcIdType, TpQuantityType>& flows, std::vector<NodeArcIdType>& lanes) const
+{
+    flows.clear();
+    lanes.clear();
+    std::vector<TpQuantityType> ress(sources);
+    std::vector<TpQuantityType> resd(destinations);
+    /// rows shipping to each destination, the backward lanes of the residual graph
+    std::vector<std::vector<NodeArcIdType>> col_rows(n);
+    
+    auto flow = [&](NodeArcIdType i, NodeArcIdType j) {
+        auto it = flows.find(n * i + j);
+        return it == flows.end() ? 0.0 : it->second;
+    };
+    auto ship = [&](NodeArcIdType i, NodeArcIdType j, TpQuantityType q) {
+        auto ins = flows.emplace(n * i + j, 0.0);
+        if(ins.second)
+        {
+            lanes.push_back(n * i + j);
+            col_rows[j].push_back(i);
+        }
+        ins.first->second += q;
+    };
+    auto fill = [&](NodeArcIdType i, NodeArcIdType j) {
+        if(ress[i] > MYEPS && resd[j] > MYEPS)
+        {
+            TpQuantityType q = std::min(std::min(ress[i], resd[j]), capacities.at(i, j));
+            if(q > MYEPS)
+            {
+                ship(i, j, q);
+                ress[i] -= q;
+                resd[j] -= q;
+            }
+        }
+    };
+    
+    /// greedy
+    if(is.empty())
+    {
+        for(NodeArcIdType i = 0; i < m; i++)
+            for(NodeArcIdType j = 0; j < n && ress[i] > MYEPS; j++)
+                fill(i, j);
+    }
+    else
+    {
+        for(std::size_t k = 0; k < is.size(); k++)
+            fill(is[k], js[k]);
+    }
+    
+    /// augmenting paths from the sources left to the destinations left (BFS), forward lanes below capacity
+    /// and backward lanes with a positive flow
+    std::vector<NodeArcIdTypeSGND> pred_row(m);
+    std::vector<NodeArcIdType> pred_col(n);
+    std::vector<bool> seen_row(m);
+    std::vector<bool> seen_col(n);
+    std::vector<NodeArcIdType> queue;
+    queue.reserve(m);
+    for(;;)
+    {
+        std::fill(seen_row.begin(), seen_row.end(), false);
+        std::fill(seen_col.begin(), seen_col.end(), false);
+        queue.clear();
+        for(NodeArcIdType i = 0; i < m; i++)
+        {
+            if(ress[i] > MYEPS)
+            {
+                seen_row[i] = true;
+                pred_row[i] = -1;
+                queue.push_back(i);
+            }
+        }
+        if(queue.empty())
+            return true;
+        
+        NodeArcIdTypeSGND t = -1;
+        for(std::size_t h = 0; h < queue.size() && t < 0; h++)
+        {
+            NodeArcIdType i = queue[h];
+            for(NodeArcIdType j = 0; j < n && t < 0; j++)
+            {
+                if(seen_col[j] || !(flow(i, j) < capacities.at(i, j) - MYEPS))
+                    continue;
+                seen_col[j] = true;
+                pred_col[j] = i;
+                if(resd[j] > MYEPS)
+                    t = j;
+                for(auto r = col_rows[j].begin(); r != col_rows[j].end() && t < 0; r++)
+                {
+                    if(!seen_row[*r] && flow(*r, j) > MYEPS)
+                    {
+                        seen_row[*r] = true;
+                        pred_row[*r] = j;
+                        queue.push_back(*r);
+                    }
+                }
+            }
+        }
+        if(t < 0)
+            return false;
+        
+        /// bottleneck, then augment
+        TpQuantityType d = resd[t];
+        NodeArcIdType i = 0;
+        for(NodeArcIdType j = t;; j = pred_row[i])
+        {
+            i = pred_col[j];
+            d = std::min(d, capacities.at(i, j) - flow(i, j));
+            if(pred_row[i] < 0)
+                break;
+            d = std::min(d, flow(i, pred_row[i]));
+        }
+        d = std::min(d, ress[i]);
+        for(NodeArcIdType j = t;; j = pred_row[i])
+        {
+            i = pred_col[j];
+            ship(i, j, d);
+            if(pred_row[i] < 0)
+                break;
+            flows[n * i + pred_row[i]] -= d;
+        }
+        ress[i] -= d;
+        resd[t] -= d;
+    }
+}
+
+void TpInstance::TProblemData::setGridCosts()
+{
+    NodeArcIdType g = std::llround(std::sqrt(m));
+    if(m != n || g * g != m)
+        throw std::invalid_argument("Grid costs need m = n = g * g");
+    
+    costs.resize(m * n, std::numeric_limits<double>::quiet_NaN());
+    TpCostType* cptr = costs.data();
+    for(NodeArcIdType i = 0; i < m; i++)
+    {
+        for(NodeArcIdType j = 0; j < n; j++)
+        {
+            double dr = double(i / g) - double(j / g);
+            double dc = double(i % g) - double(j % g);
+            cptr[n * i + j] = dr * dr + dc * dc;
+        }
+    }
+    pvars.clear();
+    this->initPVars();
+    this->computeCostStats();
+}
+
 bool TpInstance::TProblemData::hasSrcOrDstAt0()
 {
     return srcs_at_zero || dsts_at_zero;
@@ -129,6 +682,19 @@ bool TpInstance::TProblemData::hasSrcOrDstAt0()
 
 bool TpInstance::TProblemData::reduce()
 {
+    /// the slack node is never removed, the problem is reduced before balance()
+    if(costs.slackSide() != TpCostMatrix::Slack::None)
+        return reduced;
+    /// capacities refer to the lanes of the original problem
+    if(!capacities.empty())
+    {
+        if(srcs_at_zero || dsts_at_zero)
+        {
+            FILE_LOG(logINFO) << "Capacitated problem ::: sources and destinations at 0 are kept";
+        }
+        return reduced;
+    }
+    
     reduced = false;
     if(srcs_at_zero || dsts_at_zero)
     {
@@ -138,49 +704,30 @@ bool TpInstance::TProblemData::reduce()
         M = m;
         N = n;
         /// SOURCES
-        /// process sources
-        sources_map.resize(M, 0);
+        /// compact the kept sources in place, forward and backward maps in the same pass
+        sources_map.clear();
+        sources_map_bw.assign(M, 0);
         for(NodeArcIdType i = 0; i < M; i++)
-            sources_map[i] = i;
-        
-        NodeArcIdType i = 0;
-        for(auto it = sources_map.begin(); it != sources_map.end(); it++, i++)
         {
             if(sources[i] < MYEPS)
-                sources_map.erase(it--);
-        }
-        /// remove 0 srcs
-        for(auto it = sources.begin(); it != sources.end(); it++)
-        {
-            if(*it < MYEPS)
-                sources.erase(it--);
+                continue;
+            sources_map_bw[i] = sources_map.size() + 1;
+            sources[sources_map.size()] = sources[i];
+            sources_map.push_back(i);
         }
-        /// pop backward map
-        sources_map_bw.resize(M, 0);
-        for(NodeArcIdType i = 0; i < sources_map.size(); i++)
-            sources_map_bw[sources_map[i]] = i + 1;
+        sources.resize(sources_map.size());
         /// DESTINATIONS
-        /// process destionations
-        destinations_map.resize(M, 0);
+        destinations_map.clear();
+        destinations_map_bw.assign(N, 0);
         for(NodeArcIdType j = 0; j < N; j++)
-            destinations_map[j] = j;
-        
-        NodeArcIdType j = 0;
-        for(auto it = destinations_map.begin(); it != destinations_map.end(); it++, j++)
         {
             if(destinations[j] < MYEPS)
-                destinations_map.erase(it--);
-        }
-        /// remove 0 dsts
-        for(auto it = destinations.begin(); it != destinations.end(); it++)
-        {
-            if(*it < MYEPS)
-                destinations.erase(it--);
+                continue;
+            destinations_map_bw[j] = destinations_map.size() + 1;
+            destinations[destinations_map.size()] = destinations[j];
+            destinations_map.push_back(j);
         }
-        /// pop backward map
-        destinations_map_bw.resize(N, 0);
-        for(NodeArcIdType j = 0; j < destinations_map.size(); j++)
-            destinations_map_bw[destinations_map[j]] = j + 1;
+        destinations.resize(destinations_map.size());
         
         swapped = false;
         if(sources_map.size() < destinations_map.size())
@@ -195,6 +742,39 @@ bool TpInstance::TProblemData::reduce()
             swapped = true;
         }
         
+        /// redo sparse cost matrix: the arcs between the kept sources and destinations
+        if(costs.isSparse())
+        {
+            const std::vector<std::size_t>& abeg = costs.arcBegins();
+            const std::vector<NodeArcIdType>& adst = costs.arcDestinations();
+            const TpCostType* acs = costs.begin();
+            std::vector<NodeArcIdType> is;
+            std::vector<NodeArcIdType> js;
+            std::vector<TpCostType> cs;
+            for(NodeArcIdType r = 0; r < (swapped ? N : M); r++)
+            {
+                for(std::size_t a = abeg[r]; a < abeg[r + 1]; a++)
+                {
+                    NodeArcIdType i = swapped ? sources_map_bw[adst[a]] : sources_map_bw[r];
+                    NodeArcIdType j = swapped ? destinations_map_bw[r] : destinations_map_bw[adst[a]];
+                    if(i > 0 && j > 0)
+                    {
+                        is.push_back(i - 1);
+                        js.push_back(j - 1);
+                        cs.push_back(acs[a]);
+                    }
+                }
+            }
+            
+            m_orgn = m;
+            n_orgn = n;
+            m = sources_map.size();
+            n = destinations_map.size();
+            reduced = true;
+            this->setSparseCosts(is, js, cs);
+            return reduced;
+        }
+        
         /// redo cost matrix
         std::vector<double> newcmtx;
         pvars.clear();
@@ -276,9 +856,11 @@ void TpInstance::write2file(std::string ofnm)
         throw std::runtime_error("File not found");
     }
     
-    ofs << tp_data_sptr->m << " ";
-    ofs << tp_data_sptr->n << " ";
-    ofs << tp_data_sptr->rndseed;
+    const TpCostMatrix& costs = tp_data_sptr->costs;
+    if(costs.isSparse())
+        ofs << TPSPARSETAG << " " << tp_data_sptr->m << " " << tp_data_sptr->n << " " << costs.vars();
+    else
+        ofs << tp_data_sptr->m << " " << tp_data_sptr->n << " " << tp_data_sptr->rndseed;
     ofs << std::endl;
 
     for(NodeArcIdType i = 0; i < tp_data_sptr->m; i++)
@@ -297,15 +879,37 @@ void TpInstance::write2file(std::string ofnm)
     }
     ofs << std::endl;
     
-    for(NodeArcIdType i = 0; i < tp_data_sptr->m; i++)
+    /// arcs of a sparse instance, slack lanes are arcs of the written instance
+    if(costs.isSparse())
     {
-        for(NodeArcIdType j = 0; j < tp_data_sptr->n; j++)
+        for(NodeArcIdType i = 0; i < tp_data_sptr->m; i++)
         {
-            ofs << tp_data_sptr->costs[tp_data_sptr->n * i + j];
-            if(j + 1 < tp_data_sptr->n)
-                ofs << " ";
+            for(std::size_t a = costs.rowBegin(i); a < costs.rowBegin(i + 1); a++)
+                ofs << i << " " << costs.rowDestination(i, a) << " " << costs.begin()[a] << std::endl;
+            for(std::size_t s = costs.slackRowBegin(i); s < costs.slackRowBegin(i + 1); s++)
+                ofs << i << " " << costs.slackDestination(s) << " " << costs.slackCosts()[s] << std::endl;
         }
-        ofs << std::endl;
+    }
+    else
+    {
+        for(NodeArcIdType i = 0; i < tp_data_sptr->m; i++)
+        {
+            for(NodeArcIdType j = 0; j < tp_data_sptr->n; j++)
+            {
+                ofs << tp_data_sptr->costs[tp_data_sptr->n * i + j];
+                if(j + 1 < tp_data_sptr->n)
+                    ofs << " ";
+            }
+            ofs << std::endl;
+        }
+    }
+    
+    const TpCapacities& caps = tp_data_sptr->capacities;
+    if(!caps.empty())
+    {
+        ofs << TPCAPACITYTAG << " " << caps.size() << std::endl;
+        for(std::size_t k = 0; k < caps.size(); k++)
+            ofs << caps.row(k) << " " << caps.col(k) << " " << caps.capacity(k) << std::endl;
     }
     
     ofs.close();
@@ -401,8 +1005,9 @@ std::shared_ptr<TpInstance::TProblemData> TpInstance::generateData(bool ap, unsi
     double cf = 1.0 / (tpdata_sptr->m * tpdata_sptr->n);
     NodeArcIdType c = 0;
     tpdata_sptr->costs.resize(tpdata_sptr->m * tpdata_sptr->n, std::numeric_limits<double>::quiet_NaN());
+    TpCostType* cend = tpdata_sptr->costs.data() + tpdata_sptr->costs.size();
     
-    for(auto it = tpdata_sptr->costs.begin(); it != tpdata_sptr->costs.end(); it++, c++)
+    for(auto it = tpdata_sptr->costs.data(); it != cend; it++, c++)
     {
         *it = (double)rndc(rndngen);
         tpdata_sptr->pvars[c] = std::make_pair(c, *it);
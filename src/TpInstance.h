@@ -23,6 +23,9 @@
 #include <limits>
 #include <cmath>
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
 
 #define F4DDR 1e4
 
@@ -35,10 +38,404 @@ typedef unsigned NODEARC_INT_TYPE NodeArcIdType;
 typedef double TpCostType;
 typedef double TpQuantityType;
 
+/// sparse text instance file: a first line "sparse m n arcs", the supplies, the demands, then a line "i j cost"
+/// per arc (0-based indices); lanes without an arc are forbidden
+static const char TPSPARSETAG[] = "sparse";
+
+/// optional last section of a text instance file: this tag and the costs of the slack lanes of an unbalanced problem,
+/// m values if the supply exceeds the demand, n values otherwise, see TProblemData::balance()
+static const char TPSLACKTAG[] = "slack";
+
+/// optional section of a text instance file, before the slack costs if any: this tag, the number k of capacitated lanes
+/// and k lines "i j capacity" (0-based indices), see TpCapacities
+static const char TPCAPACITYTAG[] = "capacity";
+
+/// binary instance file: these 8 bytes, m, n and seed (uint64 each), m supplies, n demands
+/// and the m * n row-major costs (doubles), native byte order
+static const char TPBINMAGIC[8] = {'I', 'I', 'O', 'T', 'P', 'B', '0', '1'};
+
+/// row-major cost matrix, either owned or a read-only view of a caller-owned buffer,
+/// or sparse: the costs of the arcs only, by rows (CSR), the other lanes cost big M (artificial vars)
+/// size(), begin() and end() refer to the stored costs, i.e., the arcs of a sparse matrix
+/// An unbalanced problem has an implicit slack source (last row) or destination (last column),
+/// its lanes are not stored in the matrix
+class TpCostMatrix
+{
+public:
+    enum class Slack { None, Source, Destination };
+
+    inline TpCostMatrix() { }
+    inline TpCostMatrix(const TpCostMatrix& arg) { *this = arg; }
+
+    inline TpCostMatrix& operator=(const TpCostMatrix& arg)
+    {
+        owned = arg.owned;
+        csize = arg.csize;
+        is_view = arg.is_view;
+        cptr = is_view ? arg.cptr : owned.data();
+        is_direct = arg.is_direct;
+        is_sparse = arg.is_sparse;
+        nrows = arg.nrows;
+        ncols = arg.ncols;
+        lane_cols = arg.lane_cols;
+        arc_beg = arg.arc_beg;
+        arc_dst = arg.arc_dst;
+        big_m = arg.big_m;
+        slack_side = arg.slack_side;
+        slack_cs = arg.slack_cs;
+        return *this;
+    }
+
+    inline TpCostMatrix& operator=(const std::vector<TpCostType>& arg)
+    {
+        owned = arg;
+        own();
+        clearLanes();
+        return *this;
+    }
+
+    /// view a caller-owned buffer of sz costs, no copy
+    inline void view(const TpCostType* ptr, std::size_t sz)
+    {
+        std::vector<TpCostType>().swap(owned);
+        cptr = ptr;
+        csize = sz;
+        is_view = true;
+        clearLanes();
+    }
+
+    /// sparse matrix of n columns: the arcs of row i are beg[i], ..., beg[i + 1] - 1, sorted by destination
+    inline void sparse(std::size_t n, std::vector<std::size_t>& beg, std::vector<NodeArcIdType>& dst, std::vector<TpCostType>& cs, TpCostType bigm)
+    {
+        owned.swap(cs);
+        own();
+        arc_beg.swap(beg);
+        arc_dst.swap(dst);
+        nrows = arc_beg.size() - 1;
+        lane_cols = ncols = n;
+        big_m = bigm;
+        is_sparse = true;
+        is_direct = false;
+        slack_side = Slack::None;
+        std::vector<TpCostType>().swap(slack_cs);
+    }
+
+    /// slack node of a matrix of m x n lanes: a source, the lanes (m, j) cost cs[j],
+    /// or a destination, the lanes (i, n) cost cs[i]
+    inline void slack(Slack side, std::size_t m, std::size_t n, std::vector<TpCostType>& cs)
+    {
+        slack_cs.swap(cs);
+        slack_side = side;
+        nrows = m;
+        ncols = n;
+        lane_cols = side == Slack::Destination ? n + 1 : n;
+        is_direct = side == Slack::None && !is_sparse;
+    }
+
+    inline Slack slackSide() const
+    {
+        return slack_side;
+    }
+
+    inline const std::vector<TpCostType>& slackCosts() const
+    {
+        return slack_cs;
+    }
+
+    inline bool isView() const
+    {
+        return is_view;
+    }
+
+    inline bool isSparse() const
+    {
+        return is_sparse;
+    }
+
+    /// begin()[k] is the cost of lane k: dense, no slack node
+    inline bool isDirect() const
+    {
+        return is_direct;
+    }
+
+    /// vars of the problem: the stored costs and the slack lanes
+    inline std::size_t vars() const
+    {
+        return csize + slack_cs.size();
+    }
+
+    inline std::size_t size() const
+    {
+        return csize;
+    }
+
+    inline void resize(std::size_t sz, TpCostType v = 0.0)
+    {
+        detach();
+        clearLanes();
+        owned.resize(sz, v);
+        own();
+    }
+
+    inline const TpCostType& operator[](std::size_t k) const
+    {
+        return is_direct ? cptr[k] : laneAt(k / lane_cols, k % lane_cols);
+    }
+
+    /// cost of lane (i, j) of a matrix that is not direct, see isDirect(), out of line to keep the direct access inlined
+    const TpCostType& laneAt(std::size_t i, std::size_t j) const;
+
+    /// not direct matrices: the stored costs of row i are [rowBegin(i), rowBegin(i + 1)), lanes or arcs
+    inline std::size_t rowBegin(std::size_t i) const
+    {
+        i = std::min(i, nrows);
+        return is_sparse ? arc_beg[i] : ncols * i;
+    }
+
+    inline std::size_t rowDestination(std::size_t i, std::size_t a) const
+    {
+        return is_sparse ? arc_dst[a] : a - ncols * i;
+    }
+
+    /// the slack lanes of row i are [slackRowBegin(i), slackRowBegin(i + 1)) of the slack costs
+    inline std::size_t slackRowBegin(std::size_t i) const
+    {
+        return slack_side == Slack::Destination ? std::min(i, nrows) : slack_side == Slack::Source && i > nrows ? ncols : 0;
+    }
+
+    inline std::size_t slackDestination(std::size_t s) const
+    {
+        return slack_side == Slack::Destination ? ncols : s;
+    }
+
+    /// sparse matrix: arc of lane (i, j), -1 if none
+    inline std::ptrdiff_t arc(std::size_t i, std::size_t j) const
+    {
+        auto first = arc_dst.begin() + arc_beg[i];
+        auto last = arc_dst.begin() + arc_beg[i + 1];
+        auto it = std::lower_bound(first, last, NodeArcIdType(j));
+        return it != last && *it == j ? it - arc_dst.begin() : -1;
+    }
+
+    inline const std::vector<std::size_t>& arcBegins() const
+    {
+        return arc_beg;
+    }
+
+    inline const std::vector<NodeArcIdType>& arcDestinations() const
+    {
+        return arc_dst;
+    }
+
+    inline TpCostType bigM() const
+    {
+        return big_m;
+    }
+
+    inline void setBigM(TpCostType bigm)
+    {
+        big_m = bigm;
+    }
+
+    /// set a cost, a viewed buffer is copied first, a sparse matrix must have the arc
+    inline void set(std::size_t k, TpCostType c)
+    {
+        detach();
+        if(!is_direct)
+        {
+            std::size_t i = k / lane_cols;
+            std::size_t j = k % lane_cols;
+            if((slack_side == Slack::Source && i == nrows) || (slack_side == Slack::Destination && j == ncols))
+            {
+                slack_cs[slack_side == Slack::Source ? j : i] = c;
+                return;
+            }
+            std::ptrdiff_t a = is_sparse ? arc(i, j) : std::ptrdiff_t(ncols * i + j);
+            if(a < 0)
+                throw std::invalid_argument("No arc " + std::to_string(i) + " -> " + std::to_string(j) + " in the sparse instance");
+            k = a;
+        }
+        owned[k] = c;
+    }
+
+    /// writable data, a viewed buffer is copied first
+    inline TpCostType* data()
+    {
+        detach();
+        return owned.data();
+    }
+
+    inline const TpCostType* begin() const
+    {
+        return cptr;
+    }
+
+    inline const TpCostType* end() const
+    {
+        return cptr + csize;
+    }
+
+private:
+    inline void own()
+    {
+        cptr = owned.data();
+        csize = owned.size();
+        is_view = false;
+    }
+
+    inline void detach()
+    {
+        if(is_view)
+        {
+            owned.assign(cptr, cptr + csize);
+            own();
+        }
+    }
+
+    /// back to a dense matrix without slack node
+    inline void clearLanes()
+    {
+        std::vector<std::size_t>().swap(arc_beg);
+        std::vector<NodeArcIdType>().swap(arc_dst);
+        std::vector<TpCostType>().swap(slack_cs);
+        is_sparse = false;
+        slack_side = Slack::None;
+        is_direct = true;
+    }
+
+    std::vector<TpCostType> owned;
+    const TpCostType* cptr = nullptr;
+    std::size_t csize = 0;
+    bool is_view = false;
+    bool is_direct = true;
+    /// stored rows and columns and columns of the lanes (with the slack destination) of a matrix not direct
+    std::size_t nrows = 0;
+    std::size_t ncols = 0;
+    std::size_t lane_cols = 0;
+    /// CSR of a sparse matrix
+    bool is_sparse = false;
+    std::vector<std::size_t> arc_beg;
+    std::vector<NodeArcIdType> arc_dst;
+    TpCostType big_m = 0.0;
+    /// slack node
+    Slack slack_side = Slack::None;
+    std::vector<TpCostType> slack_cs;
+};
+
+/// upper bounds (capacities) of some lanes, sparse by rows (CSR): the capacities of row i are [rowBegin(i), rowBegin(i + 1)),
+/// sorted by destination; the other lanes, the slack lanes included, are uncapacitated
+class TpCapacities
+{
+public:
+    /// capacities us[k] of the lanes (is[k], js[k]) (any order, no duplicates) of a problem of m sources
+    inline void set(std::size_t m, const std::vector<NodeArcIdType>& is, const std::vector<NodeArcIdType>& js, const std::vector<TpQuantityType>& us)
+    {
+        if(is.size() != js.size() || is.size() != us.size())
+            throw std::invalid_argument("Capacities ::: " + std::to_string(is.size()) + " sources, " + std::to_string(js.size()) +
+                                        " destinations and " + std::to_string(us.size()) + " values");
+        /// counting sort by row, then by destination within rows
+        std::vector<std::size_t> beg(m + 1, 0);
+        for(std::size_t k = 0; k < is.size(); k++)
+        {
+            if(is[k] >= m)
+                throw std::invalid_argument("Capacity of lane " + std::to_string(is[k]) + " -> " + std::to_string(js[k]) + " out of range");
+            if(!(us[k] >= 0.0))
+                throw std::invalid_argument("Negative capacity of lane " + std::to_string(is[k]) + " -> " + std::to_string(js[k]));
+            ++beg[is[k] + 1];
+        }
+        for(std::size_t i = 0; i < m; i++)
+            beg[i + 1] += beg[i];
+        std::vector<std::size_t> pos(beg.begin(), beg.end() - 1);
+        std::vector<std::pair<NodeArcIdType, TpQuantityType>> lanes(is.size());
+        for(std::size_t k = 0; k < is.size(); k++)
+            lanes[pos[is[k]]++] = std::make_pair(js[k], us[k]);
+
+        row_beg.swap(beg);
+        cis.assign(lanes.size(), 0);
+        cjs.resize(lanes.size());
+        cus.resize(lanes.size());
+        for(std::size_t i = 0; i < m; i++)
+        {
+            std::sort(lanes.begin() + row_beg[i], lanes.begin() + row_beg[i + 1]);
+            for(std::size_t k = row_beg[i]; k < row_beg[i + 1]; k++)
+            {
+                if(k > row_beg[i] && lanes[k].first == lanes[k - 1].first)
+                    throw std::invalid_argument("Duplicate capacity of lane " + std::to_string(i) + " -> " + std::to_string(lanes[k].first));
+                cis[k] = i;
+                cjs[k] = lanes[k].first;
+                cus[k] = lanes[k].second;
+            }
+        }
+    }
+
+    inline void clear()
+    {
+        std::vector<std::size_t>().swap(row_beg);
+        std::vector<NodeArcIdType>().swap(cis);
+        std::vector<NodeArcIdType>().swap(cjs);
+        std::vector<TpQuantityType>().swap(cus);
+    }
+
+    inline bool empty() const
+    {
+        return cus.empty();
+    }
+
+    /// capacitated lanes
+    inline std::size_t size() const
+    {
+        return cus.size();
+    }
+
+    /// position of the capacity of lane (i, j), -1 if uncapacitated
+    inline std::ptrdiff_t find(std::size_t i, std::size_t j) const
+    {
+        if(i + 1 >= row_beg.size())
+            return -1;
+        auto first = cjs.begin() + row_beg[i];
+        auto last = cjs.begin() + row_beg[i + 1];
+        auto it = std::lower_bound(first, last, NodeArcIdType(j));
+        return it != last && *it == j ? it - cjs.begin() : -1;
+    }
+
+    /// capacity of lane (i, j), infinity if uncapacitated
+    inline TpQuantityType at(std::size_t i, std::size_t j) const
+    {
+        std::ptrdiff_t k = this->find(i, j);
+        return k < 0 ? std::numeric_limits<TpQuantityType>::infinity() : cus[k];
+    }
+
+    inline std::size_t rowBegin(std::size_t i) const
+    {
+        return row_beg.empty() ? 0 : row_beg[std::min(i, row_beg.size() - 1)];
+    }
+
+    inline NodeArcIdType row(std::size_t k) const
+    {
+        return cis[k];
+    }
+
+    inline NodeArcIdType col(std::size_t k) const
+    {
+        return cjs[k];
+    }
+
+    inline TpQuantityType capacity(std::size_t k) const
+    {
+        return cus[k];
+    }
+
+private:
+    std::vector<std::size_t> row_beg;
+    std::vector<NodeArcIdType> cis;
+    std::vector<NodeArcIdType> cjs;
+    std::vector<TpQuantityType> cus;
+};
+
 class TpInstance
 {
 public:
-    typedef std::vector<TpCostType> tcosts;
+    typedef TpCostMatrix tcosts;
 
     struct TProblemData
     {
@@ -70,6 +467,11 @@ public:
         std::vector<NodeArcIdType> destinations_map;
         std::vector<NodeArcIdType> sources_map_bw;
         std::vector<NodeArcIdType> destinations_map_bw;
+        /// costs of the slack lanes of balance(), per source if the supply exceeds the demand, per destination otherwise,
+        /// 0 if empty
+        std::vector<TpCostType> slack_costs;
+        /// capacities of the lanes, none if empty (uncapacitated problem)
+        TpCapacities capacities;
         
         std::string name = "";
         std::string initial_base_fname = "current_base.txt";
@@ -77,8 +479,33 @@ public:
         bool dump_down_sol = false;
         unsigned long long max_macroiter = (std::numeric_limits<unsigned long long>::max)();
         
-        /// method to remove srcs and dsts with 0 q.
+        /// method to remove srcs and dsts with 0 q., before balance()
         bool reduce();
+        /// unbalanced problem: add a slack destination taking the excess supply or a slack source
+        /// covering the unmet demand (last destination or source), its lanes are not stored, see TpCostMatrix
+        /// after quantity changes, the slack node of a previous call is resized, or removed if on the wrong side
+        /// returns false if balanced
+        bool balance();
+        /// remove the slack node of balance(), if any
+        void unbalance();
+        /// recompute totals and 0 q. counters of srcs and dsts
+        void computeQuantityStats();
+        /// recompute min., max. and average cost
+        void computeCostStats();
+        /// fill-in pvars if empty
+        void initPVars();
+        /// squared Euclidean costs, sources and destinations on the same sqrt(m) x sqrt(m) grid
+        void setGridCosts();
+        /// sparse costs of the arcs (is[a], js[a]) (any order, no duplicates), the other lanes cost big M,
+        /// more than any solution on the arcs; quantities must be set
+        void setSparseCosts(const std::vector<NodeArcIdType>& is, const std::vector<NodeArcIdType>& js, const std::vector<TpCostType>& cs);
+        /// capacities us[k] of the lanes (is[k], js[k]) (any order, no duplicates), the problem is not reduced
+        void setCapacities(const std::vector<NodeArcIdType>& is, const std::vector<NodeArcIdType>& js, const std::vector<TpQuantityType>& us);
+        /// capacitated problem: a feasible flow, the lanes (is[k], js[k]) (all the lanes by rows if empty) are filled greedily
+        /// in this order, then the supplies left are shipped along augmenting paths; flows[n * i + j] of the lanes with
+        /// a positive flow, lanes lists them in the order they are filled; false if the capacities admit no feasible flow
+        bool capacitatedFlow(const std::vector<NodeArcIdType>& is, const std::vector<NodeArcIdType>& js,
+                             std::unordered_map<NodeArcIdType, TpQuantityType>& flows, std::vector<NodeArcIdType>& lanes) const;
         bool hasSrcOrDstAt0();
         void logStrictInfo();
     };
@@ -86,11 +513,17 @@ public:
     typedef struct TProblemData* TProblemDataPtr;
     typedef struct TProblemData& TProblemDataRef;
         
+    /// text (dense or sparse) or binary instance file
     TpInstance(std::string);
+    /// in-memory instance, costs are a view of the caller buffer of m * n row-major costs
+    TpInstance(NodeArcIdType m, NodeArcIdType n, const TpQuantityType* supplies, const TpQuantityType* demands, const TpCostType* costs);
     ~TpInstance();
 
     std::string getBaseName();
     std::string getName();
+    /// sources m and destinations n from the header of an instance file (dense or sparse text, or binary),
+    /// the rest of the file is not read; false if the header is not readable
+    static bool readSize(std::string fname, NodeArcIdType& m, NodeArcIdType& n);
 
     bool isToGenerate();
     bool isToWrite();
@@ -102,9 +535,15 @@ public:
     
     const std::shared_ptr<TProblemData>& getInstanceData();
     std::shared_ptr<TProblemData> generateData();
-    std::shared_ptr<TProblemData> generateData(bool, unsigned int, unsigned int, double, double, NodeArcIdType, NodeArcIdType, unsigned long long, unsigned int iid = 1);
+    /// random instance (ap, min. q., max. q., min. cost, max. cost, m, n, seed), no instance object needed
+    static std::shared_ptr<TProblemData> generateData(bool, unsigned int, unsigned int, double, double, NodeArcIdType, NodeArcIdType, unsigned long long, unsigned int iid = 1);
 
 private:
+    void readBinary(std::istream&);
+    void readSparse(std::istream&);
+    /// optional capacities and slack costs at the end of a text file
+    void readTrailer(std::istream&);
+    
     std::string ifname;
     bool to_generate = false;
     bool to_write_to_file = false;
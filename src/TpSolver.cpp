@@ -0,0 +1,236 @@
+///
+/// src/algs/TpSolver.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "TpSolver.h"
+#include "util.h"
+#include "MyLog.h"
+
+
+TpSolver::TpSolver(NodeArcIdType m, NodeArcIdType n,
+                   const TpQuantityType* supplies,
+                   const TpQuantityType* demands,
+                   const TpCostType* costs,
+                   unsigned long long mode,
+                   unsigned long long wsf,
+                   unsigned long long ws2f,
+                   double pf)
+    : inst_sptr(new TpInstance(m, n, supplies, demands, costs))
+    , m(m)
+    , n(n)
+{
+    tpdata_sptr = inst_sptr->getInstanceData();
+    tspx_sptr.reset(new TSimplex(tpdata_sptr, mode, wsf, ws2f, pf));
+}
+
+TpSolver::~TpSolver()
+{
+}
+
+void TpSolver::setThreads(unsigned int thrds)
+{
+    tspx_sptr->setThreads(thrds);
+}
+
+void TpSolver::setTimeLimit(double tl)
+{
+    tlim = tl;
+}
+
+void TpSolver::setCancelFlag(const std::atomic<bool>* flag)
+{
+    tspx_sptr->setCancelFlag(flag);
+}
+
+void TpSolver::setProgressCallback(const TSimplex::progress_callback& cb, unsigned long every_iters)
+{
+    tspx_sptr->setProgressCallback(cb, every_iters);
+}
+
+optresult TpSolver::solve()
+{
+    if(applyCostChanges() || costs_changed)
+    {
+        tpdata_sptr->pvars.clear();
+        tpdata_sptr->computeCostStats();
+    }
+    tpdata_sptr->balance();
+
+    tspx_sptr->setWarmStart(false);
+    last_optres = tspx_sptr->tsimplex(tlim);
+    solved = true;
+    costs_changed = quantities_changed = false;
+
+    return last_optres;
+}
+
+optresult TpSolver::resolve()
+{
+    if(!solved)
+        return solve();
+
+    /// only a few costs changed: the basis stays primal feasible, re-price them
+    if(!costs_changed && !quantities_changed && !cost_changes.empty())
+    {
+        last_optres = tspx_sptr->updateCosts(cost_changes, tlim);
+        cost_changes.clear();
+        return last_optres;
+    }
+
+    /// only quantities changed: the basis stays dual feasible, dual simplex pivots
+    if(!costs_changed && quantities_changed && cost_changes.empty())
+    {
+        last_optres = tspx_sptr->updateQuantities(std::vector<TpQuantityType>(tpdata_sptr->sources.begin(), tpdata_sptr->sources.begin() + m),
+                                                  std::vector<TpQuantityType>(tpdata_sptr->destinations.begin(), tpdata_sptr->destinations.begin() + n),
+                                                  tlim);
+        quantities_changed = false;
+        return last_optres;
+    }
+
+    /// sorted vars and cost bounds are rebuilt from the new costs
+    costs_changed = applyCostChanges() || costs_changed;
+    if(costs_changed)
+    {
+        tpdata_sptr->pvars.clear();
+        tpdata_sptr->computeCostStats();
+    }
+    tpdata_sptr->balance();
+
+    FILE_LOG(logINFO) << "Re-solve from the last basis"
+                      << " ::: costs changed >> " << (costs_changed ? "Yes" : "No")
+                      << " ::: quantities changed >> " << (quantities_changed ? "Yes" : "No");
+
+    tspx_sptr->setWarmStart(true);
+    last_optres = tspx_sptr->tsimplex(tlim);
+    costs_changed = quantities_changed = false;
+
+    return last_optres;
+}
+
+void TpSolver::setSupply(NodeArcIdType i, TpQuantityType q)
+{
+    if(i >= m)
+        throw std::out_of_range("No source " + std::to_string(i));
+
+    tpdata_sptr->sources[i] = q;
+    quantities_changed = true;
+}
+
+void TpSolver::setDemand(NodeArcIdType j, TpQuantityType q)
+{
+    if(j >= n)
+        throw std::out_of_range("No destination " + std::to_string(j));
+
+    tpdata_sptr->destinations[j] = q;
+    quantities_changed = true;
+}
+
+void TpSolver::setCost(NodeArcIdType i, NodeArcIdType j, TpCostType c)
+{
+    if(i >= m || j >= n)
+        throw std::out_of_range("No variable (" + std::to_string(i) + "," + std::to_string(j) + ")");
+
+    cost_changes.push_back(std::make_tuple(i, j, c));
+}
+
+void TpSolver::costsChanged()
+{
+    costs_changed = true;
+}
+
+void TpSolver::setCapacities(const std::vector<flow_type>& capacities)
+{
+    std::vector<NodeArcIdType> is;
+    std::vector<NodeArcIdType> js;
+    std::vector<TpQuantityType> us;
+    for(auto it = capacities.begin(); it != capacities.end(); it++)
+    {
+        if(std::get<0>(*it) >= m || std::get<1>(*it) >= n)
+            throw std::out_of_range("No variable (" + std::to_string(std::get<0>(*it)) + "," + std::to_string(std::get<1>(*it)) + ")");
+        is.push_back(std::get<0>(*it));
+        js.push_back(std::get<1>(*it));
+        us.push_back(std::get<2>(*it));
+    }
+    if(is.empty())
+        tpdata_sptr->capacities.clear();
+    else
+        tpdata_sptr->setCapacities(is, js, us);
+}
+
+double TpSolver::getObjValue()
+{
+    checkSolved();
+
+    return last_optres.obj_value;
+}
+
+void TpSolver::getFlows(std::vector<flow_type>& flows)
+{
+    checkSolved();
+
+    const std::shared_ptr<tplex_alg_data>& tplexd_sptr = tspx_sptr->getAlgData();
+    auto arcs_sptr = tplexd_sptr->vdata.spat_sptr->getTSpxSolV2();
+    NodeArcIdType N = tpdata_sptr->n;
+    double q;
+
+    /// basic vars with a non-zero flow, the slack lanes of an unbalanced problem excluded
+    flows.clear();
+    for(auto it = arcs_sptr->begin(); it != arcs_sptr->end(); it++)
+    {
+        if(it->first >= m || it->second >= n)
+            continue;
+        if((q = std::round(tplexd_sptr->quantities.get(N * it->first + it->second))) > 0.0)
+            flows.push_back(std::make_tuple(it->first, it->second, q));
+    }
+    /// nonbasic vars at their upper bound of a capacitated problem
+    const TpCapacities& caps = tpdata_sptr->capacities;
+    for(auto it = tplexd_sptr->vdata.upper.begin(); it != tplexd_sptr->vdata.upper.end(); it++)
+        if(caps.capacity(*it) > 0.0)
+            flows.push_back(std::make_tuple(caps.row(*it), caps.col(*it), caps.capacity(*it)));
+}
+
+void TpSolver::getDuals(std::vector<double>& us, std::vector<double>& vs)
+{
+    checkSolved();
+
+    /// multipliers of the last basis with v of the tree root at 0
+    us.assign(tpdata_sptr->m, 0.0);
+    vs.assign(tpdata_sptr->n, 0.0);
+    tspx_sptr->getAlgData()->vdata.spat_sptr->computeTSpxMultips(tpdata_sptr->costs, us, vs);
+    /// the multiplier of the slack node, if any, is not returned
+    us.resize(m);
+    vs.resize(n);
+}
+
+bool TpSolver::applyCostChanges()
+{
+    for(auto it = cost_changes.begin(); it != cost_changes.end(); it++)
+        tpdata_sptr->costs.set(tpdata_sptr->n * std::get<0>(*it) + std::get<1>(*it), std::get<2>(*it));
+
+    bool applied = !cost_changes.empty();
+    cost_changes.clear();
+
+    return applied;
+}
+
+void TpSolver::checkSolved()
+{
+    if(!solved || tspx_sptr->getAlgData() == nullptr || tspx_sptr->getAlgData()->vdata.spat_sptr == nullptr)
+        throw std::runtime_error("No solution, call solve() first");
+}
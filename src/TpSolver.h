@@ -0,0 +1,97 @@
+///
+/// src/algs/TpSolver.h
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef TPSOLVER_H
+#define TPSOLVER_H
+
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <tuple>
+#include <limits>
+
+#include "TpInstance.h"
+#include "TSimplex.h"
+#include "optresult.h"
+
+///
+/// Library entry point: solves a t. problem given by caller-owned buffers
+/// and re-solves it from the last basis after changes of its data
+///
+class TpSolver
+{
+public:
+    typedef std::tuple<NodeArcIdType, NodeArcIdType, TpQuantityType> flow_type;
+
+    /// costs are m * n row-major values, the buffer is not copied and must outlive the solver
+    TpSolver(NodeArcIdType m, NodeArcIdType n,
+             const TpQuantityType* supplies,
+             const TpQuantityType* demands,
+             const TpCostType* costs,
+             unsigned long long mode = 23111,
+             unsigned long long window_size_factor = 10,
+             unsigned long long window_size_2_factor = 1,
+             double partition_factor = 10.0);
+    ~TpSolver();
+
+    void setThreads(unsigned int);
+    void setTimeLimit(double);
+    /// solve() and resolve() stop, not optimal, as soon as the flag is set
+    void setCancelFlag(const std::atomic<bool>*);
+    /// invoked every given number of simplex iterations, returns false to stop
+    void setProgressCallback(const TSimplex::progress_callback&, unsigned long every_iters = 100);
+
+    /// solve from scratch, an unbalanced problem with a slack node, see TProblemData::balance()
+    optresult solve();
+    /// solve from the last basis, from scratch if never solved
+    optresult resolve();
+
+    /// data changes, applied by the next resolve()
+    void setSupply(NodeArcIdType i, TpQuantityType q);
+    void setDemand(NodeArcIdType j, TpQuantityType q);
+    /// a viewed cost buffer is copied when the change is applied
+    void setCost(NodeArcIdType i, NodeArcIdType j, TpCostType c);
+    /// the caller updated the viewed cost buffer in place
+    void costsChanged();
+    /// capacities (i, j, capacity) of some lanes, none if empty; capacitated problems are always solved from scratch
+    void setCapacities(const std::vector<flow_type>& capacities);
+
+    /// solution
+    double getObjValue();
+    void getFlows(std::vector<flow_type>& flows);
+    void getDuals(std::vector<double>& us, std::vector<double>& vs);
+
+private:
+    bool applyCostChanges();
+    void checkSolved();
+
+    std::shared_ptr<TpInstance> inst_sptr;
+    std::shared_ptr<TpInstance::TProblemData> tpdata_sptr;
+    std::shared_ptr<TSimplex> tspx_sptr;
+    optresult last_optres;
+    /// sources and destinations of the caller, the slack node of an unbalanced problem excluded
+    NodeArcIdType m;
+    NodeArcIdType n;
+
+    double tlim = std::numeric_limits<double>::quiet_NaN();
+    bool solved = false;
+    bool costs_changed = false;
+    bool quantities_changed = false;
+    /// cost changes of setCost(..) not yet applied
+    std::vector<TSimplex::cost_change> cost_changes;
+};
+
+#endif // TPSOLVER_H
@@ -0,0 +1,166 @@
+///
+/// src/utility/autocfg.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "autocfg.h"
+#include "util.h"
+#include "MyLog.h"
+
+/// sampled costs for the cost features
+#define AUTOSAMPLES 4096
+
+///
+/// decision table, the first matching rule wins
+///
+/// calibrated on 300x300, 1000x1000, 500x800 and 100x2000 random instances (costs 1-1000 and 1-10),
+/// 100x100 and 500x500 assignment instances, and 30x30 and 40x40 grids with squared Euclidean costs:
+/// IIO is the fastest or within noise on all non-grid families, cost ties and degenerate
+/// quantities included; grids gain 2x-15x with the multiscale basis and shielding
+///
+struct auto_rule
+{
+    const char* family;
+    /// squared Euclidean grid costs required
+    bool sqeuclid_grid;
+    /// min. max(m, n) / min(m, n)
+    double min_aspect;
+    unsigned long long mode;
+    unsigned int intp0;
+    unsigned int intp1;
+    double dblp0;
+};
+
+static const auto_rule auto_rules[] =
+{
+    /// multiscale initial basis, shielding, sorted vars
+    {"sqeuclid grid", true,  1.0,  34111, 28, 1, 0.0},
+    /// one side much smaller than the other: Dantzig's rule on partitioned vars
+    {"skewed",        false, 10.0, 23000, 10, 1, 10.0},
+    /// IIO
+    {"dense",         false, 1.0,  23111, 10, 1, 10.0}
+};
+
+instance_features compute_features(const TpInstance::TProblemData& tpdata)
+{
+    instance_features ftrs;
+    std::minstd_rand rng(1);
+    std::vector<double> smpl;
+    NodeArcIdType M = tpdata.m;
+    NodeArcIdType N = tpdata.n;
+    NodeArcIdType MO = tpdata.reduced ? tpdata.m_orgn : M;
+    NodeArcIdType NO = tpdata.reduced ? tpdata.n_orgn : N;
+    unsigned long long mn = (unsigned long long)M * N;
+    unsigned long long smplct = std::min(mn, (unsigned long long)AUTOSAMPLES);
+
+    ftrs.m = M;
+    ftrs.n = N;
+    ftrs.aspect = double(std::max(M, N)) / std::max(std::min(M, N), NodeArcIdType(1));
+    ftrs.minc = tpdata.minc;
+    ftrs.maxc = tpdata.maxc;
+    ftrs.avgc = tpdata.avgc;
+
+    /// sampled (i, j) pairs, all if few
+    std::vector<std::pair<NodeArcIdType, NodeArcIdType>> pairs;
+    pairs.reserve(smplct);
+    for(unsigned long long k = 0; k < smplct; k++)
+    {
+        unsigned long long v = smplct < mn ? (((unsigned long long)rng() << 31) ^ rng()) % mn : k;
+        pairs.push_back(std::make_pair(v / N, v % N));
+    }
+
+    /// cost ties
+    smpl.reserve(smplct);
+    for(auto it = pairs.begin(); it != pairs.end(); it++)
+        smpl.push_back(tpdata.costs[N * it->first + it->second]);
+    std::sort(smpl.begin(), smpl.end());
+    ftrs.cost_distinct_ratio = smpl.empty() ? 1.0 : double(std::unique(smpl.begin(), smpl.end()) - smpl.begin()) / smpl.size();
+
+    /// degenerate quantities
+    smpl.assign(tpdata.sources.begin(), tpdata.sources.end());
+    smpl.insert(smpl.end(), tpdata.destinations.begin(), tpdata.destinations.end());
+    std::sort(smpl.begin(), smpl.end());
+    ftrs.quantity_distinct_ratio = smpl.empty() ? 1.0 : double(std::unique(smpl.begin(), smpl.end()) - smpl.begin()) / smpl.size();
+
+    /// square grids, positions of the original sources and destinations if reduced
+    NodeArcIdType g = std::llround(std::sqrt(MO));
+    if(MO == NO && g * g == MO && g > 1)
+    {
+        double ratio = std::numeric_limits<double>::quiet_NaN();
+        bool is_grid = true;
+        for(auto it = pairs.begin(); it != pairs.end() && is_grid; it++)
+        {
+            NodeArcIdType oi = tpdata.reduced ? tpdata.sources_map[it->first] : it->first;
+            NodeArcIdType oj = tpdata.reduced ? tpdata.destinations_map[it->second] : it->second;
+            double dr = double(oi / g) - double(oj / g);
+            double dc = double(oi % g) - double(oj % g);
+            double d2 = dr * dr + dc * dc;
+            double c = tpdata.costs[N * it->first + it->second];
+            if(d2 < MYEPS)
+                is_grid = std::abs(c) < MYEPS;
+            else if(std::isnan(ratio))
+                is_grid = (ratio = c / d2) > 0.0;
+            else
+                is_grid = std::abs(c / d2 - ratio) <= MYEPS * std::max(1.0, ratio);
+        }
+        ftrs.sqeuclid_grid = is_grid && !std::isnan(ratio);
+        ftrs.grid_side = g;
+    }
+
+    return ftrs;
+}
+
+optcfg auto_config(const instance_features& ftrs, const optcfg& base)
+{
+    const auto_rule* rule = &auto_rules[sizeof(auto_rules) / sizeof(auto_rule) - 1];
+    for(const auto_rule& r : auto_rules)
+    {
+        if((!r.sqeuclid_grid || ftrs.sqeuclid_grid) && ftrs.aspect >= r.min_aspect)
+        {
+            rule = &r;
+            break;
+        }
+    }
+
+    optcfg optc = base;
+    optc.opt_algo = optcfg::Algo::TS;
+    optc.alg_mode = rule->mode;
+    optc.intp0 = rule->intp0;
+    optc.intp1 = rule->intp1;
+    optc.dblp0 = rule->dblp0;
+
+    FILE_LOG(logINFO) << "Auto configuration ::: instance family >> " << rule->family
+                      << " ::: " << getAlg(optc.opt_algo) << " " << optc.alg_mode << " " << optc.intp0 << " " << optc.intp1 << " " << optc.dblp0;
+
+    return optc;
+}
+
+std::string log_features(const instance_features& ftrs)
+{
+    std::stringstream ss;
+    ss << "Instance features:\n";
+    ss << "\t\t\tm x n: " << ftrs.m << " x " << ftrs.n << std::endl;
+    ss << "\t\t\tAspect ratio: " << ftrs.aspect << std::endl;
+    ss << "\t\t\tCosts min/max/avg: " << ftrs.minc << " / " << ftrs.maxc << " / " << ftrs.avgc << std::endl;
+    ss << "\t\t\tDistinct sampled costs: " << ftrs.cost_distinct_ratio * 100.0 << " %" << std::endl;
+    ss << "\t\t\tDistinct quantities: " << ftrs.quantity_distinct_ratio * 100.0 << " %" << std::endl;
+    ss << "\t\t\tSquared Euclidean grid: " << (ftrs.sqeuclid_grid ? "Yes, side " + std::to_string(ftrs.grid_side) : std::string("No"));
+    return ss.str();
+}
@@ -0,0 +1,53 @@
+///
+/// src/utility/autocfg.h
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef AUTOCFG_H
+#define AUTOCFG_H
+
+#include <string>
+
+#include "TpInstance.h"
+#include "optcfg.h"
+
+/// cheap instance features for the configuration choice of algorithm 'auto'
+struct instance_features
+{
+    NodeArcIdType m = 0;
+    NodeArcIdType n = 0;
+    /// max(m, n) / min(m, n)
+    double aspect = 1.0;
+    double minc = 0.0;
+    double maxc = 0.0;
+    double avgc = 0.0;
+    /// distinct values over sampled costs, small values mean many cost ties
+    double cost_distinct_ratio = 1.0;
+    /// distinct values over supplies and demands, small values mean degenerate bases (e.g., 1 / (m + n) for assignment problems)
+    double quantity_distinct_ratio = 1.0;
+    /// m = n = g * g and sampled costs are proportional to squared Euclidean distances on the g x g grid
+    bool sqeuclid_grid = false;
+    NodeArcIdType grid_side = 0;
+};
+
+instance_features compute_features(const TpInstance::TProblemData&);
+
+/// the configuration of the first rule of the built-in decision table matching the features,
+/// time limit and threads are those of the given configuration
+optcfg auto_config(const instance_features&, const optcfg&);
+
+/// function prototype
+std::string log_features(const instance_features&);
+
+#endif // AUTOCFG_H
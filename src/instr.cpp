@@ -0,0 +1,108 @@
+///
+/// src/utility/instr.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <sstream>
+#include <iomanip>
+
+#include "instr.h"
+
+namespace Instr
+{
+    void stats::reset()
+    {
+        *this = stats();
+    }
+
+    stats& local()
+    {
+        static thread_local stats st;
+        return st;
+    }
+
+    std::string getCounter(Counter c)
+    {
+        switch(c)
+        {
+            case ITERATIONS: return std::string("iterations");
+            case PIVOTS: return std::string("pivots");
+            case DEGENERATE_PIVOTS: return std::string("degenerate pivots");
+            case LOOPS: return std::string("loops");
+            case SAVED_LOOP_SEARCHES: return std::string("saved loop searches");
+            case TREE_UPDATES: return std::string("tree updates");
+            case PRICED_CELLS: return std::string("priced cells");
+            default: return std::string("none");
+        }
+    }
+
+    std::string getHist(Hist h)
+    {
+        switch(h)
+        {
+            case LOOP_LEN_STEP1: return std::string("loop length, step 1");
+            case LOOP_LEN_STEP2: return std::string("loop length, step 2");
+            case PIVOTS_PER_ITER: return std::string("pivots per iteration");
+            case PRICED_CELLS_PER_ITER: return std::string("priced cells per iteration");
+            default: return std::string("none");
+        }
+    }
+
+    std::string getTimer(Timer t)
+    {
+        switch(t)
+        {
+            case MULTIPLIERS: return std::string("multipliers");
+            case PRICING: return std::string("pricing");
+            case FIND_LOOP: return std::string("find loop and move q.");
+            case TREE_UPDATE: return std::string("tree update");
+            default: return std::string("none");
+        }
+    }
+
+    std::string report(const stats& st)
+    {
+        std::stringstream ss;
+        ss << "Instrumentation:";
+        for(unsigned int c = 0; c < COUNTERS; c++)
+            ss << "\n\t\t\t" << std::setw(28) << std::left << getCounter(Counter(c)) << std::right << std::setw(16) << st.counters[c];
+        for(unsigned int t = 0; t < TIMERS; t++)
+        {
+            /// sampled time scaled to all calls
+            double ms = st.timer_sampled[t] ? st.timer_ns[t] / 1.0e6 * st.timer_calls[t] / st.timer_sampled[t] : 0.0;
+            ss << "\n\t\t\t" << std::setw(28) << std::left << getTimer(Timer(t)) << std::right
+               << std::setw(16) << std::fixed << std::setprecision(3) << ms << " [ms] (est.)"
+               << " ::: calls >> " << st.timer_calls[t]
+               << " ::: sampled >> " << st.timer_sampled[t];
+        }
+        for(unsigned int h = 0; h < HISTS; h++)
+        {
+            const histogram& hst = st.hists[h];
+            ss << "\n\t\t\t" << getHist(Hist(h))
+               << " ::: n >> " << hst.n
+               << " ::: avg >> " << std::fixed << std::setprecision(2) << (hst.n ? double(hst.sum) / hst.n : 0.0)
+               << " ::: max >> " << hst.max;
+            /// non-empty buckets as [lo, hi] count
+            for(unsigned int b = 0; b < histogram::BUCKETS; b++)
+            {
+                if(!hst.counts[b])
+                    continue;
+                unsigned long long lo = b ? 1ULL << (b - 1) : 0;
+                unsigned long long hi = b ? (1ULL << b) - 1 : 0;
+                ss << "\n\t\t\t    [" << lo << ", " << hi << "] " << hst.counts[b];
+            }
+        }
+        return ss.str();
+    }
+}
@@ -0,0 +1,149 @@
+///
+/// src/utility/instr.h
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef INSTR_H
+#define INSTR_H
+
+#include <string>
+#include <chrono>
+
+///
+/// Runtime-switchable hot-path instrumentation: counters, log2 histograms and scoped timers
+/// of the calling thread; the instrumented code holds a stats pointer, nullptr when disabled
+///
+namespace Instr
+{
+    enum Counter
+    {
+        ITERATIONS,
+        PIVOTS,
+        DEGENERATE_PIVOTS,
+        LOOPS,
+        SAVED_LOOP_SEARCHES,
+        TREE_UPDATES,
+        PRICED_CELLS,
+        COUNTERS
+    };
+
+    enum Hist
+    {
+        LOOP_LEN_STEP1,
+        LOOP_LEN_STEP2,
+        PIVOTS_PER_ITER,
+        PRICED_CELLS_PER_ITER,
+        HISTS
+    };
+
+    enum Timer
+    {
+        MULTIPLIERS,
+        PRICING,
+        FIND_LOOP,
+        TREE_UPDATE,
+        TIMERS
+    };
+
+    /// bucket 0 counts 0s, bucket b > 0 counts values in [2^(b-1), 2^b)
+    struct histogram
+    {
+        static const unsigned int BUCKETS = 48;
+
+        unsigned long long counts[BUCKETS] = {};
+        unsigned long long n = 0;
+        unsigned long long sum = 0;
+        unsigned long long max = 0;
+
+        inline void add(unsigned long long v)
+        {
+            unsigned int b = 0;
+            for(unsigned long long w = v; w && b < BUCKETS - 1; w >>= 1)
+                ++b;
+            ++counts[b];
+            ++n;
+            sum += v;
+            if(v > max)
+                max = v;
+        }
+    };
+
+    struct stats
+    {
+        unsigned long long counters[COUNTERS] = {};
+        histogram hists[HISTS];
+        /// nanoseconds of the sampled calls, started, completed and sampled calls
+        unsigned long long timer_ns[TIMERS] = {};
+        unsigned long long timer_ticks[TIMERS] = {};
+        unsigned long long timer_calls[TIMERS] = {};
+        unsigned long long timer_sampled[TIMERS] = {};
+
+        void reset();
+    };
+
+    /// stats of the calling thread
+    stats& local();
+
+    /// 1 in timerSample(t) calls is timed: clock reads at every pivot would cost more than most of the timed code
+    inline unsigned long long timerSample(Timer t)
+    {
+        return t == FIND_LOOP || t == TREE_UPDATE ? 16 : 1;
+    }
+
+    /// timer start, no clock read if disabled or not sampled
+    inline std::chrono::steady_clock::time_point tick(stats* st, Timer t)
+    {
+        if(st == nullptr || st->timer_ticks[t]++ % timerSample(t))
+            return std::chrono::steady_clock::time_point();
+        return std::chrono::steady_clock::now();
+    }
+    /// timer stop, a tick without tock is not a call
+    inline void tock(stats* st, Timer t, const std::chrono::steady_clock::time_point& start)
+    {
+        if(st == nullptr)
+            return;
+        ++st->timer_calls[t];
+        if(start != std::chrono::steady_clock::time_point())
+        {
+            st->timer_ns[t] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            ++st->timer_sampled[t];
+        }
+    }
+
+    class scoped_timer
+    {
+    public:
+        scoped_timer(stats* s, Timer t) : st(s), tmr(t), start(tick(s, t))
+        {
+        }
+        ~scoped_timer()
+        {
+            tock(st, tmr, start);
+        }
+
+    private:
+        stats* st;
+        Timer tmr;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// function prototypes
+    std::string getCounter(Counter);
+    std::string getHist(Hist);
+    std::string getTimer(Timer);
+    /// multi-line report for the log
+    std::string report(const stats&);
+}
+
+#endif // INSTR_H
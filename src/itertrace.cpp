@@ -0,0 +1,121 @@
+///
+/// src/utility/itertrace.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <stdexcept>
+#include <cstring>
+#include <iomanip>
+
+#include "itertrace.h"
+
+static const char TRACEMAGIC[8] = {'I', 'I', 'O', 'T', 'R', 'C', '0', '1'};
+
+
+TraceWriter::TraceWriter(const std::string& fname, std::size_t buffer_records)
+    : ofs(fname, std::ios::binary), buf_records(buffer_records > 0 ? buffer_records : 1)
+{
+    if(!ofs)
+        throw std::runtime_error("File creation fails");
+
+    uint32_t hdr[2] = {(uint32_t)sizeof(iter_record), 0};
+    ofs.write(TRACEMAGIC, sizeof(TRACEMAGIC));
+    ofs.write(reinterpret_cast<const char*>(hdr), sizeof(hdr));
+
+    fill_buf.reserve(buf_records);
+    write_buf.reserve(buf_records);
+    writer = std::thread(&TraceWriter::run, this);
+}
+
+TraceWriter::~TraceWriter()
+{
+    this->close();
+}
+
+void TraceWriter::handOff()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    /// wait for the writer to drain the previous buffer
+    cv.wait(lock, [this]() { return write_buf.empty(); });
+    fill_buf.swap(write_buf);
+    cv.notify_all();
+}
+
+void TraceWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while(true)
+    {
+        cv.wait(lock, [this]() { return !write_buf.empty() || closing; });
+        if(write_buf.empty())
+            break;
+
+        /// the solver thread fills the other buffer meanwhile
+        lock.unlock();
+        ofs.write(reinterpret_cast<const char*>(write_buf.data()), write_buf.size() * sizeof(iter_record));
+        lock.lock();
+
+        write_buf.clear();
+        cv.notify_all();
+    }
+}
+
+void TraceWriter::close()
+{
+    if(!writer.joinable())
+        return;
+
+    if(!fill_buf.empty())
+        this->handOff();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closing = true;
+    }
+    cv.notify_all();
+    writer.join();
+    ofs.close();
+}
+
+std::vector<iter_record> read_trace(const std::string& fname)
+{
+    std::ifstream ifs(fname, std::ios::binary);
+    if(!ifs.is_open())
+        throw std::runtime_error("File not found");
+
+    char magic[sizeof(TRACEMAGIC)];
+    uint32_t hdr[2];
+    if(!ifs.read(magic, sizeof(magic)) || std::memcmp(magic, TRACEMAGIC, sizeof(magic)) != 0
+       || !ifs.read(reinterpret_cast<char*>(hdr), sizeof(hdr)))
+        throw std::invalid_argument("Not an iteration trace file '" + fname + "'");
+    if(hdr[0] != sizeof(iter_record))
+        throw std::invalid_argument("Trace record size " + std::to_string(hdr[0]) + ", expected " + std::to_string(sizeof(iter_record)));
+
+    std::vector<iter_record> recs;
+    iter_record rec;
+    while(ifs.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+        recs.push_back(rec);
+
+    return recs;
+}
+
+void write_trace_csv(const std::vector<iter_record>& recs, std::ostream& os)
+{
+    os << "iter,priced_cells,entering,pivots,degenerate,objf,elapsed_ms,multips_ms,pricing_ms,pivoting_ms\n";
+    for(auto it = recs.begin(); it != recs.end(); it++)
+    {
+        os << it->iter << ',' << it->priced_cells << ',' << it->entering << ',' << it->pivots << ',' << it->degenerate << ','
+           << std::setprecision(17) << it->objf_value << ','
+           << std::setprecision(6) << it->elapsed << ',' << it->multips_time << ',' << it->pricing_time << ',' << it->pivoting_time << '\n';
+    }
+}
@@ -0,0 +1,96 @@
+///
+/// src/utility/itertrace.h
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef ITERTRACE_H
+#define ITERTRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+///
+/// Per-iteration trace of the simplex main loop
+///
+/// Binary file: the 8 bytes "IIOTRC01", the record size and a reserved value (uint32 each),
+/// then one fixed-size record per iteration, native byte order
+///
+struct iter_record
+{
+    uint64_t iter = 0;
+    /// reduced costs computed by the pricing
+    uint64_t priced_cells = 0;
+    /// entering vars of the pricing, pivots and pivots with theta 0
+    uint32_t entering = 0;
+    uint32_t pivots = 0;
+    uint32_t degenerate = 0;
+    uint32_t reserved = 0;
+    /// obj. f. after the pivots
+    double objf_value = 0.0;
+    /// [ms]
+    double elapsed = 0.0;
+    double multips_time = 0.0;
+    double pricing_time = 0.0;
+    double pivoting_time = 0.0;
+};
+
+///
+/// Buffered trace writer: records are written by a background thread, one buffer at a time,
+/// so the solver thread only copies the record
+///
+class TraceWriter
+{
+public:
+    TraceWriter(const std::string& fname, std::size_t buffer_records = 4096);
+    ~TraceWriter();
+
+    void push(const iter_record& rec)
+    {
+        fill_buf.push_back(rec);
+        if(fill_buf.size() >= buf_records)
+            this->handOff();
+    }
+    /// write the buffered records and the file, no push after close
+    void close();
+
+private:
+    void handOff();
+    void run();
+
+    std::ofstream ofs;
+    std::size_t buf_records;
+    std::vector<iter_record> fill_buf;
+    std::vector<iter_record> write_buf;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool closing = false;
+    std::thread writer;
+};
+
+/// function prototypes
+
+/// all the records of a trace file, throws if not a trace file
+std::vector<iter_record> read_trace(const std::string& fname);
+
+/// CSV with a header line
+void write_trace_csv(const std::vector<iter_record>& recs, std::ostream& os);
+
+
+#endif // ITERTRACE_H
@@ -46,6 +46,7 @@
 
 #include <sstream>
 #include <string>
+#include <atomic>
 #include <stdio.h>
 
 inline std::string NowTime();
@@ -132,7 +133,11 @@ class Output2FILE
 {
 public:
     static FILE*& Stream();
-    static void Output(const std::string& msg);
+    /// asynchronous output (see init_logging in MyLog.h), false if the message is to be written by the caller,
+    /// set by the writer thread while the logging threads read it
+    typedef bool (*AsyncOutputFn)(std::string&);
+    static std::atomic<AsyncOutputFn>& AsyncOutput();
+    static void Output(std::string msg);
 };
 
 inline FILE*& Output2FILE::Stream()
@@ -141,8 +146,17 @@ inline FILE*& Output2FILE::Stream()
     return pStream;
 }
 
-inline void Output2FILE::Output(const std::string& msg)
+inline std::atomic<Output2FILE::AsyncOutputFn>& Output2FILE::AsyncOutput()
 {
+    static std::atomic<AsyncOutputFn> pAsync(nullptr);
+    return pAsync;
+}
+
+inline void Output2FILE::Output(std::string msg)
+{
+    AsyncOutputFn pAsync = AsyncOutput().load(std::memory_order_acquire);
+    if (pAsync && pAsync(msg))
+        return;
     FILE* pStream = Stream();
     if (!pStream)
         return;
@@ -15,16 +15,107 @@
 ///
 
 #include <stdio.h>
+#include <thread>
 #include "TpInstance.h"
 #include "optcfg.h"
 
 #include "TSimplex.h"
+#include "CostScaling.h"
+#include "autocfg.h"
+#include "optbatch.h"
+#include "optrace.h"
+#include "optregress.h"
 #include "MyLog.h"
 #include "util.h"
 
 
 int main(int argc, char **argv)
 {
+    /// batch mode: iio -batch manifest results [workers]
+    if(argc > 3 && std::string(argv[1]) == "-batch")
+    {
+        std::string resfname(argv[3]);
+        std::string logfn = resfname.substr(resfname.find_last_of("/") + 1, resfname.size()) + ".log";
+        unsigned long failed = 0;
+        try
+        {
+            init_logging(false, logfn, LOGLEVEL, "w+", true);
+            failed = run_batch(argv[2], resfname, argc > 4 ? std::stoul(argv[4]) : std::thread::hardware_concurrency());
+            init_logging(true, logfn);
+        }
+        catch(std::exception& e)
+        {
+            std::cout << "Program thrown an exception, msg: " << e.what() << std::endl << std::endl;
+            return -1;
+        }
+        
+        return failed ? 1 : 0;
+    }
+    /// race mode: iio -race instance cfg cfg [cfg ...]
+    if(argc > 4 && std::string(argv[1]) == "-race")
+    {
+        std::string ifname(argv[2]);
+        std::string basefn = ifname.substr(ifname.find_last_of("/") + 1, ifname.size());
+        basefn = basefn.substr(0, basefn.find_last_of("."));
+        std::string logfn = basefn + "_race.log";
+        try
+        {
+            init_logging(false, logfn, LOGLEVEL, "w+", true);
+            
+            /// read the problem instance, shared by all racers
+            std::shared_ptr<TpInstance> inst_sptr(new TpInstance(ifname));
+            #ifdef REDINST
+            if(inst_sptr->getInstanceData()->reduce())
+            {
+                FILE_LOG(logINFO)  << "Problem reduced (0 value rows and columns removed)";
+            }
+            #endif
+            inst_sptr->getInstanceData()->balance();
+            
+            optresult optres = run_race(inst_sptr->getInstanceData(), std::vector<std::string>(argv + 3, argv + argc));
+            optres.tags[0] = basefn;
+            optres.write(basefn + "_race.optres");
+            init_logging(true, logfn);
+        }
+        catch(std::exception& e)
+        {
+            std::cout << "Program thrown an exception, msg: " << e.what() << std::endl << std::endl;
+            return -1;
+        }
+        
+        return 0;
+    }
+    /// regression mode: iio -regress results baseline|- cfg [cfg ...]
+    if(argc > 4 && std::string(argv[1]) == "-regress")
+    {
+        std::string resfname(argv[2]);
+        std::string basefname(argv[3]);
+        std::string logfn = resfname.substr(resfname.find_last_of("/") + 1, resfname.size()) + ".log";
+        unsigned long flagged = 0;
+        try
+        {
+            /// synchronous logging, every run is a child process without the log writer thread
+            init_logging(false, logfn, LOGLEVEL, "w+", false);
+            flagged = run_regression(std::vector<std::string>(argv + 4, argv + argc), resfname, basefname == "-" ? "" : basefname);
+            init_logging(true, logfn);
+        }
+        catch(std::exception& e)
+        {
+            std::cout << "Program thrown an exception, msg: " << e.what() << std::endl << std::endl;
+            return -1;
+        }
+        
+        return flagged ? 1 : 0;
+    }
+    if(argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " instance cfg [stdo]" << std::endl;
+        std::cout << "       " << argv[0] << " -batch manifest results [workers]" << std::endl;
+        std::cout << "       " << argv[0] << " -race instance cfg cfg [cfg ...]" << std::endl;
+        std::cout << "       " << argv[0] << " -regress results baseline|- cfg [cfg ...]" << std::endl;
+        return -1;
+    }
+    
     std::string ifname(argv[1]);
     std::string cfgfname(argv[2]);
     bool stdout  = argc > 3;
@@ -40,10 +131,11 @@ int main(int argc, char **argv)
         basefn = basefn.substr(0, basefn.find_last_of("."));
         std::string resfn = std::string(basefn + "_" + getAlg(optc.opt_algo) + "_" + std::to_string(optc.alg_mode) + ".optres");
         std::string logfn = std::string(basefn + "_" + getAlg(optc.opt_algo) + "_" + std::to_string(optc.alg_mode) + ".log");
+        std::string trcfn = std::string(basefn + "_" + getAlg(optc.opt_algo) + "_" + std::to_string(optc.alg_mode) + ".iiotrace");
         
         /// prepare logging
         if(!stdout)
-            init_logging(false, logfn, LOGLEVEL, "w+");
+            init_logging(false, logfn, LOGLEVEL, "w+", true);
 
         /// read the problem instance
         std::shared_ptr<TpInstance> inst_sptr(new TpInstance(ifname));
@@ -58,13 +150,47 @@ int main(int argc, char **argv)
             FILE_LOG(logINFO)  << "Problem reduced (0 value rows and columns removed)";
         }
         #endif
+        /// slack node if unbalanced
+        inst_sptr->getInstanceData()->balance();
+        
+        /// choose the configuration from the instance features
+        if(optc.opt_algo == optcfg::Algo::AUTO)
+        {
+            instance_features ftrs = compute_features(*inst_sptr->getInstanceData());
+            FILE_LOG(logINFO) << log_features(ftrs);
+            optc = auto_config(ftrs, optc);
+        }
 
         /// solve
+        if(optc.opt_algo == optcfg::Algo::CS)
+        {
+            CostScaling cs(inst_sptr->getInstanceData(), optc.alg_mode, optc.intp0);
+            
+            /// get opt. data
+            optresult optres = cs.solve(optc.timelimsec, true, true);
+            
+            /// update tags
+            optres.tags.resize(optres.tags_cnt);
+            optres.tags[0] = basefn;
+            optres.tags[1] = getAlg(optc.opt_algo) + "_" + std::to_string(optc.alg_mode);
+            
+            /// print opt. result to file
+            optres.write(resfn);
+            
+            if(!stdout)
+                init_logging(true, logfn);
+            
+            return 0;
+        }
         TSimplex tspx(inst_sptr->getInstanceData(), 
                       optc.alg_mode, 
                       optc.intp0, 
                       optc.intp1, 
                       optc.dblp0);
+        tspx.setThreads(optc.threads2use);
+        tspx.setInstrumentation(optc.instr);
+        if(optc.trace)
+            tspx.setTraceFile(trcfn);
         
         /// get opt. data
         optresult optres = tspx.tsimplex(optc.timelimsec, true, true);
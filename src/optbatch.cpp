@@ -0,0 +1,182 @@
+///
+/// src/utility/optbatch.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+#include "optbatch.h"
+#include "optcfg.h"
+#include "TpInstance.h"
+#include "TSimplex.h"
+#include "CostScaling.h"
+#include "autocfg.h"
+#include "MyLog.h"
+#include "util.h"
+
+
+std::vector<batch_job> read_manifest(std::string mfname)
+{
+    /// open input file
+    std::ifstream ifs(mfname);
+    
+    if(!ifs.is_open())
+    {
+        throw std::runtime_error("File not found");
+    }
+    
+    std::vector<batch_job> jobs;
+    std::string line;
+    while(std::getline(ifs, line))
+    {
+        /// skip comments and empty lines
+        line = line.substr(0, line.find('#'));
+        std::istringstream iss(line);
+        batch_job job;
+        if(!(iss >> job.inst_fname))
+            continue;
+        if(!(iss >> job.cfg_fname))
+            throw std::invalid_argument("Bad manifest line '" + line + "', expected instance and configuration files");
+        
+        /// read the problem size from the instance header
+        NodeArcIdType m = 0;
+        NodeArcIdType n = 0;
+        if(TpInstance::readSize(job.inst_fname, m, n))
+            job.size = (unsigned long long)m * n;
+        
+        jobs.push_back(job);
+    }
+    
+    return jobs;
+}
+
+/// solve one job, reusing the algorithm data buffers of the previous solve of the worker
+static optresult solve_job(const batch_job& job, std::shared_ptr<tplex_alg_data>& buf_sptr)
+{
+    /// read configuration file
+    optcfg optc(job.cfg_fname);
+    
+    std::string basefn = job.inst_fname;
+    basefn = basefn.substr(basefn.find_last_of("/") + 1, basefn.size());
+    basefn = basefn.substr(0, basefn.find_last_of("."));
+    
+    /// read the problem instance
+    std::shared_ptr<TpInstance> inst_sptr(new TpInstance(job.inst_fname));
+    
+    /// reduce instances if 0 r/c
+    #ifdef REDINST
+    inst_sptr->getInstanceData()->reduce();
+    #endif
+    inst_sptr->getInstanceData()->balance();
+    
+    /// choose the configuration from the instance features
+    if(optc.opt_algo == optcfg::Algo::AUTO)
+        optc = auto_config(compute_features(*inst_sptr->getInstanceData()), optc);
+    
+    /// solve
+    optresult optres;
+    if(optc.opt_algo == optcfg::Algo::LP)
+    {
+        throw std::invalid_argument("Algorithm '" + getAlg(optc.opt_algo) + "' not supported in batch mode");
+    }
+    else if(optc.opt_algo == optcfg::Algo::CS)
+    {
+        CostScaling cs(inst_sptr->getInstanceData(), optc.alg_mode, optc.intp0);
+        optres = cs.solve(optc.timelimsec, false, false);
+    }
+    else
+    {
+        TSimplex tspx(inst_sptr->getInstanceData(), 
+                      optc.alg_mode, 
+                      optc.intp0, 
+                      optc.intp1, 
+                      optc.dblp0);
+        tspx.setThreads(optc.threads2use);
+        tspx.setInstrumentation(optc.instr);
+        if(optc.trace)
+            tspx.setTraceFile(basefn + "_" + getAlg(optc.opt_algo) + "_" + std::to_string(optc.alg_mode) + ".iiotrace");
+        if(buf_sptr != nullptr)
+            tspx.setAlgData(buf_sptr);
+        
+        optres = tspx.tsimplex(optc.timelimsec, false, false);
+        buf_sptr = tspx.getAlgData();
+    }
+    
+    /// update tags
+    optres.tags.resize(optres.tags_cnt);
+    optres.tags[0] = basefn;
+    optres.tags[1] = getAlg(optc.opt_algo) + "_" + std::to_string(optc.alg_mode);
+    
+    return optres;
+}
+
+unsigned long run_batch(std::string mfname, std::string resfname, unsigned int workers)
+{
+    std::vector<batch_job> jobs = read_manifest(mfname);
+    
+    /// largest instances first, jobs of the same size are contiguous so data buffers get reused
+    std::stable_sort(jobs.begin(), jobs.end(), [](const batch_job& a, const batch_job& b) { return a.size > b.size; });
+    
+    std::ofstream ofs(resfname);
+    if(!ofs) 
+        throw std::runtime_error("File creation fails");
+    
+    workers = std::max(1u, std::min(workers, (unsigned int)jobs.size()));
+    FILE_LOG(logINFO) << "Batch of " << jobs.size() << " jobs ::: workers >> " << workers;
+    
+    auto start = std::chrono::steady_clock::now();
+    std::mutex res_mtx;
+    std::atomic<std::size_t> next_job(0);
+    std::atomic<unsigned long> failed(0);
+    
+    /// each worker takes the next job until none is left
+    auto worker = [&]()
+    {
+        std::shared_ptr<tplex_alg_data> buf_sptr(nullptr);
+        for(std::size_t k = next_job++; k < jobs.size(); k = next_job++)
+        {
+            try
+            {
+                optresult optres = solve_job(jobs[k], buf_sptr);
+                
+                std::lock_guard<std::mutex> lock(res_mtx);
+                optres.write(ofs);
+            }
+            catch(std::exception& e)
+            {
+                FILE_LOG(logERROR) << "Job " << jobs[k].inst_fname << " " << jobs[k].cfg_fname << " failed, msg: " << e.what();
+                ++failed;
+            }
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    for(unsigned int w = 0; w < workers; w++)
+        pool.emplace_back(worker);
+    for(auto it = pool.begin(); it != pool.end(); it++)
+        it->join();
+    
+    FILE_LOG(logINFO) << "Batch done ::: time >> " << std::fixed << std::setprecision(3)
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0 << " [s]"
+                      << " ::: failed jobs >> " << failed;
+    
+    return failed;
+}
@@ -0,0 +1,40 @@
+///
+/// src/utility/optbatch.h
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef OPTBATCH_H
+#define OPTBATCH_H
+
+#include <string>
+#include <vector>
+
+/// a manifest line: instance file and configuration file
+struct batch_job
+{
+    std::string inst_fname;
+    std::string cfg_fname;
+    /// problem size m x n read from the instance header, used for ordering jobs
+    unsigned long long size = 0;
+};
+
+/// function prototypes
+std::vector<batch_job> read_manifest(std::string);
+
+/// solve all the jobs of a manifest with a pool of workers, results go to a single file
+/// returns the number of failed jobs
+unsigned long run_batch(std::string manifest_fname, std::string results_fname, unsigned int workers);
+
+
+#endif // OPTBATCH_H
@@ -40,6 +40,26 @@ void optcfg::read(std::string cfgfname)
     ifs >> timelimsec;
     ifs >> dblp0;
     
+    /// optional key=value parameters
+    std::string kvstr;
+    while(ifs >> kvstr)
+    {
+        std::size_t eqpos = kvstr.find('=');
+        if(eqpos == std::string::npos)
+            throw std::invalid_argument("Bad configuration parameter '" + kvstr + "', expected key=value");
+        
+        std::string key = kvstr.substr(0, eqpos);
+        std::string val = kvstr.substr(eqpos + 1);
+        if(key == "threads")
+            threads2use = std::stoul(val);
+        else if(key == "instr")
+            instr = std::stoul(val) != 0;
+        else if(key == "trace")
+            trace = std::stoul(val) != 0;
+        else
+            throw std::invalid_argument("Unknown configuration parameter '" + key + "'");
+    }
+    
     return;
 }
 
@@ -49,6 +69,8 @@ std::string getAlg(optcfg::Algo opta)
     {
         case optcfg::Algo::LP: return std::string("lp");
         case optcfg::Algo::TS: return std::string("ts");
+        case optcfg::Algo::CS: return std::string("cs");
+        case optcfg::Algo::AUTO: return std::string("auto");
         default: return std::string("none");
     }
 }
@@ -63,6 +85,14 @@ optcfg::Algo getAlg(std::string algstr)
     {
         return optcfg::Algo::TS;
     }
+    else if(algstr == "cs")
+    {
+        return optcfg::Algo::CS;
+    }
+    else if(algstr == "auto")
+    {
+        return optcfg::Algo::AUTO;
+    }
     else
     {
         throw std::invalid_argument("Unknown algorithm '" + algstr + "'");
@@ -78,6 +108,8 @@ std::string log_opt_config(optcfg ocfg)
     ss << "\t\t\tAlgorithm mode: " << ocfg.alg_mode << std::endl;
     ss << "\t\t\tMax mem for solver: " << ocfg.maxmem << std::endl;
     ss << "\t\t\tMax nr of threads: " << ocfg.threads2use << std::endl;
+    ss << "\t\t\tInstrumentation: " << (ocfg.instr ? "Yes" : "No") << std::endl;
+    ss << "\t\t\tIteration trace: " << (ocfg.trace ? "Yes" : "No") << std::endl;
     ss << "\t\t\tTime limit [s]: " << ocfg.timelimsec << std::endl;
     ss << "\t\t\tMax opt gap allowed: " << ocfg.maxgap << std::endl;    
     ss << "\t\t\tInt param 0: " << ocfg.intp0 << std::endl;    
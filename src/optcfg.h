@@ -25,7 +25,10 @@ struct optcfg
     enum Algo
     {
         LP,
-        TS
+        TS,
+        CS,
+        /// TS with the mode of the instance features, see autocfg.h
+        AUTO
     };
     
     /// Configuration parameters
@@ -34,6 +37,10 @@ struct optcfg
     
     unsigned int            maxmem = 512;
     unsigned int            threads2use = 1;
+    /// hot-path instrumentation of the simplex, see instr.h
+    bool                    instr = false;
+    /// per-iteration binary trace of the simplex, see itertrace.h
+    bool                    trace = false;
     
     double                  timelimsec = 600;
     double                  maxgap = 0.0;
@@ -0,0 +1,124 @@
+///
+/// src/utility/optrace.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+#include "optrace.h"
+#include "optcfg.h"
+#include "TSimplex.h"
+#include "autocfg.h"
+#include "MyLog.h"
+#include "util.h"
+
+
+optresult run_race(const std::shared_ptr<TpInstance::TProblemData>& tpdata_sptr, const std::vector<std::string>& cfg_fnames)
+{
+    std::vector<optcfg> cfgs;
+    std::vector<optresult> results;
+    std::vector<bool> failed;
+    
+    /// read configurations
+    instance_features ftrs = compute_features(*tpdata_sptr);
+    std::vector<std::string> racer_fnames;
+    for(auto it = cfg_fnames.begin(); it != cfg_fnames.end(); it++)
+    {
+        optcfg optc(*it);
+        if(optc.opt_algo == optcfg::Algo::AUTO)
+            optc = auto_config(ftrs, optc);
+        if(optc.opt_algo != optcfg::Algo::TS)
+            throw std::invalid_argument("Algorithm '" + getAlg(optc.opt_algo) + "' not supported in race mode");
+        /// shielding neighbourhoods are exact for squared Euclidean grid costs only, a wrong optimum would win the race
+        if(optc.alg_mode / 1000 % 10 == 4 && !ftrs.sqeuclid_grid)
+        {
+            FILE_LOG(logWARNING) << "Racer " << *it << " skipped ::: shielding needs squared Euclidean grid costs";
+            continue;
+        }
+        cfgs.push_back(optc);
+        racer_fnames.push_back(*it);
+    }
+    if(cfgs.empty())
+        throw std::invalid_argument("No configuration to race");
+    results.resize(cfgs.size());
+    failed.resize(cfgs.size(), false);
+    
+    /// the racers only read the problem data, the sorted vars are built once here
+    tpdata_sptr->initPVars();
+    
+    FILE_LOG(logINFO) << "Race of " << cfgs.size() << " configurations";
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<bool> cancel(false);
+    std::mutex win_mtx;
+    long winner = -1;
+    
+    auto racer = [&](std::size_t k)
+    {
+        try
+        {
+            TSimplex tspx(tpdata_sptr, cfgs[k].alg_mode, cfgs[k].intp0, cfgs[k].intp1, cfgs[k].dblp0);
+            tspx.setThreads(cfgs[k].threads2use);
+            tspx.setInstrumentation(cfgs[k].instr);
+            tspx.setCancelFlag(&cancel);
+            results[k] = tspx.tsimplex(cfgs[k].timelimsec, false, false);
+            
+            if(results[k].tags[2] == "Optimal")
+            {
+                std::lock_guard<std::mutex> lock(win_mtx);
+                if(winner < 0)
+                {
+                    winner = k;
+                    cancel = true;
+                }
+            }
+        }
+        catch(std::exception& e)
+        {
+            FILE_LOG(logERROR) << "Racer " << racer_fnames[k] << " failed, msg: " << e.what();
+            failed[k] = true;
+        }
+    };
+    
+    std::vector<std::thread> racers;
+    for(std::size_t k = 0; k < cfgs.size(); k++)
+        racers.emplace_back(racer, k);
+    for(auto it = racers.begin(); it != racers.end(); it++)
+        it->join();
+    
+    /// no optimal racer: best obj. f. value
+    if(winner < 0)
+    {
+        for(std::size_t k = 0; k < cfgs.size(); k++)
+            if(!failed[k] && (winner < 0 || results[k].obj_value < results[winner].obj_value))
+                winner = k;
+        if(winner < 0)
+            throw std::runtime_error("All racers failed");
+    }
+    
+    FILE_LOG(logINFO) << "Race done ::: winner >> " << racer_fnames[winner]
+                      << " ::: " << results[winner].tags[2]
+                      << " ::: Obj F >> " << std::fixed << std::setprecision(0) << results[winner].obj_value
+                      << " ::: time >> " << std::setprecision(3)
+                      << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0 << " [ms]";
+    
+    optresult optres = results[winner];
+    optres.tags.resize(optres.tags_cnt);
+    optres.tags[1] = "race_" + getAlg(cfgs[winner].opt_algo) + "_" + std::to_string(cfgs[winner].alg_mode);
+    
+    return optres;
+}
@@ -0,0 +1,36 @@
+///
+/// src/utility/optrace.h
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef OPTRACE_H
+#define OPTRACE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TpInstance.h"
+#include "optresult.h"
+
+/// function prototypes
+
+/// solve the problem with the t. simplex configurations of the given files, one thread each,
+/// on the same problem data: the first optimal racer cancels the others
+/// returns the result of the winner, tag [1] is race_<winner algo>_<winner mode>,
+/// or of the best racer if none is optimal
+optresult run_race(const std::shared_ptr<TpInstance::TProblemData>& tpdata_sptr, const std::vector<std::string>& cfg_fnames);
+
+
+#endif // OPTRACE_H
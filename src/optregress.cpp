@@ -0,0 +1,435 @@
+///
+/// src/utility/optregress.cpp
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <functional>
+#include <cmath>
+#include <cstdio>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#endif
+
+#include "optregress.h"
+#include "optcfg.h"
+#include "TpGenerator.h"
+#include "optresult.h"
+#include "TSimplex.h"
+#include "CostScaling.h"
+#include "autocfg.h"
+#include "MyLog.h"
+#include "util.h"
+
+/// relative tolerance of the objective check across configurations
+#define REGRESSOBJTOL 1.0e-9
+/// [s] baseline runtimes below this value are timer noise, not compared
+#define REGRESSMINTIME 0.05
+
+
+std::vector<ladder_instance> regression_ladder()
+{
+    std::vector<ladder_instance> ladder;
+
+    ladder_instance li;
+    li.name = "reg_tp_100x100";     li.m = 100;  li.n = 100;  li.seed = 1001; ladder.push_back(li);
+    li.name = "reg_tp_200x600";     li.m = 200;  li.n = 600;  li.seed = 1002; ladder.push_back(li);
+    li.name = "reg_tp_500x500";     li.m = 500;  li.n = 500;  li.seed = 1003; ladder.push_back(li);
+    li.name = "reg_tp_1000x1000";   li.m = 1000; li.n = 1000; li.seed = 1004; ladder.push_back(li);
+    li.ap = true;
+    li.name = "reg_ap_100x100";     li.m = 100;  li.n = 100;  li.seed = 2001; ladder.push_back(li);
+    li.name = "reg_ap_500x500";     li.m = 500;  li.n = 500;  li.seed = 2002; ladder.push_back(li);
+    li.ap = false;
+    li.grid = true;
+    li.name = "reg_grid_20x20";     li.m = 400;  li.n = 400;  li.seed = 3001; ladder.push_back(li);
+    li.name = "reg_grid_40x40";     li.m = 1600; li.n = 1600; li.seed = 3002; ladder.push_back(li);
+    li.grid = false;
+    /// structured families of TpGenerator
+    li.family = "euclid";
+    li.name = "reg_euclid_300x300"; li.m = 300;  li.n = 300;  li.seed = 4001; ladder.push_back(li);
+    li.family = "clustered";
+    li.name = "reg_clust_300x500";  li.m = 300;  li.n = 500;  li.seed = 4002; ladder.push_back(li);
+    li.family = "forbidden";
+    li.name = "reg_forb_300x300";   li.m = 300;  li.n = 300;  li.seed = 4003; ladder.push_back(li);
+    li.family = "grid";
+    li.name = "reg_sqgrid_30x30";   li.m = 900;  li.n = 900;  li.seed = 4004; ladder.push_back(li);
+    li.family = "sparse";
+    li.name = "reg_sparse_500x500"; li.m = 500;  li.n = 500;  li.seed = 4005; ladder.push_back(li);
+    /// unbalanced, slack destination and slack source
+    li.family = "uniform";
+    li.surplus = 0.2;
+    li.name = "reg_excess_300x400"; li.m = 300;  li.n = 400;  li.seed = 4006; ladder.push_back(li);
+    li.family = "euclid";
+    li.surplus = -0.1;
+    li.name = "reg_short_400x300";  li.m = 400;  li.n = 300;  li.seed = 4007; ladder.push_back(li);
+    /// capacitated lanes
+    li.family = "capacitated";
+    li.surplus = 0.0;
+    li.name = "reg_cap_300x300";    li.m = 300;  li.n = 300;  li.seed = 4008; ladder.push_back(li);
+
+    return ladder;
+}
+
+static std::shared_ptr<TpInstance::TProblemData> generate_instance(const ladder_instance& li)
+{
+    std::shared_ptr<TpInstance::TProblemData> tpdata_sptr;
+    if(li.family.empty())
+    {
+        tpdata_sptr = TpInstance::generateData(li.ap, li.minq, li.maxq, li.minc, li.maxc, li.m, li.n, li.seed);
+        if(li.grid)
+            tpdata_sptr->setGridCosts();
+    }
+    else
+    {
+        TpGenerator::params prms;
+        prms.ap = li.ap;
+        prms.minq = li.minq;
+        prms.maxq = li.maxq;
+        prms.minc = li.minc;
+        prms.maxc = li.maxc;
+        prms.m = li.m;
+        prms.n = li.n;
+        prms.seed = li.seed;
+        prms.surplus = li.surplus;
+        TpGenerator::setFamily(li.family, prms);
+        tpdata_sptr = TpGenerator(prms).generate();
+    }
+    tpdata_sptr->computeQuantityStats();
+    tpdata_sptr->name = li.name;
+
+    /// reduce instances if 0 r/c
+    #ifdef REDINST
+    tpdata_sptr->reduce();
+    #endif
+    tpdata_sptr->balance();
+
+    return tpdata_sptr;
+}
+
+/// solve with a configuration, 'auto' already resolved
+static optresult solve_run(const std::shared_ptr<TpInstance::TProblemData>& tpdata_sptr, const optcfg& optc)
+{
+    optresult optres;
+    if(optc.opt_algo == optcfg::Algo::CS)
+    {
+        CostScaling cs(tpdata_sptr, optc.alg_mode, optc.intp0);
+        optres = cs.solve(optc.timelimsec, false, false);
+    }
+    else if(optc.opt_algo == optcfg::Algo::TS)
+    {
+        TSimplex tspx(tpdata_sptr, optc.alg_mode, optc.intp0, optc.intp1, optc.dblp0);
+        tspx.setThreads(optc.threads2use);
+        tspx.setInstrumentation(optc.instr);
+        optres = tspx.tsimplex(optc.timelimsec, false, false);
+    }
+    else
+    {
+        throw std::invalid_argument("Algorithm '" + getAlg(optc.opt_algo) + "' not supported in regression mode");
+    }
+
+    return optres;
+}
+
+#ifndef _WIN32
+/// run the job in a child process: the peak RSS of the child is the one of the solve only
+/// the child writes the output of the job to a pipe, returns false if the job failed
+static bool run_forked(const std::function<std::string()>& job, std::string& out, double& peak_mb)
+{
+    int fds[2];
+    if(pipe(fds) != 0)
+        throw std::runtime_error("Pipe creation fails");
+
+    /// buffered output would be written twice
+    std::fflush(nullptr);
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error("Process creation fails");
+    }
+    if(pid == 0)
+    {
+        close(fds[0]);
+        int rv = 0;
+        try
+        {
+            std::string res = job();
+            for(std::size_t w = 0; w < res.size(); )
+            {
+                ssize_t r = write(fds[1], res.data() + w, res.size() - w);
+                if(r < 0 && errno == EINTR)
+                    continue;
+                if(r <= 0)
+                    break;
+                w += r;
+            }
+        }
+        catch(std::exception& e)
+        {
+            FILE_LOG(logERROR) << "Run failed, msg: " << e.what();
+            rv = 1;
+        }
+        close(fds[1]);
+        std::fflush(nullptr);
+        _exit(rv);
+    }
+
+    close(fds[1]);
+    out.clear();
+    char buf[4096];
+    while(true)
+    {
+        ssize_t r = read(fds[0], buf, sizeof(buf));
+        if(r < 0 && errno == EINTR)
+            continue;
+        if(r <= 0)
+            break;
+        out.append(buf, r);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage ru;
+    while(wait4(pid, &status, 0, &ru) < 0)
+        if(errno != EINTR)
+            throw std::runtime_error("Wait for the run process fails");
+    #ifdef __APPLE__
+    peak_mb = ru.ru_maxrss / (1024.0 * 1024.0);
+    #else
+    peak_mb = ru.ru_maxrss / 1024.0;
+    #endif
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+#endif
+
+/// status, objective, runtime and basis changes of an .optres line
+static void parse_optres_line(const std::string& line, regress_row& row)
+{
+    std::istringstream iss(line);
+    std::vector<std::string> toks;
+    std::string tok;
+    while(iss >> tok)
+        toks.push_back(tok);
+    if(toks.size() < 14)
+        throw std::invalid_argument("Bad optimization result line '" + line + "'");
+
+    row.optstatus = toks[2];
+    row.objvalue = std::stod(toks[6]);
+    row.runtime = std::stod(toks[8]);
+    /// intv5, basis changes
+    row.pivots = std::stoll(toks[13]);
+}
+
+std::vector<regress_row> read_regress_table(std::string fname)
+{
+    std::ifstream ifs(fname);
+    if(!ifs.is_open())
+        throw std::runtime_error("File not found");
+
+    std::vector<regress_row> rows;
+    std::string line;
+    while(std::getline(ifs, line))
+    {
+        std::istringstream iss(line);
+        regress_row row;
+        std::string objv, rt, rss, brt;
+        if(!(iss >> row.ifname))
+            continue;
+        if(!(iss >> row.algorithm >> row.optstatus >> objv >> rt >> row.pivots >> rss >> brt >> row.flag))
+            throw std::invalid_argument("Bad regression table line '" + line + "'");
+        row.objvalue = std::stod(objv);
+        row.runtime = std::stod(rt);
+        row.peakrss = std::stod(rss);
+        row.baseruntime = std::stod(brt);
+        rows.push_back(row);
+    }
+
+    return rows;
+}
+
+static void write_regress_row(std::ostream& os, const regress_row& row)
+{
+    os << row.ifname << " " << row.algorithm << " " << row.optstatus << " "
+       << std::setprecision(4) << std::fixed << row.objvalue << " "
+       << std::setprecision(4) << std::fixed << row.runtime << " "
+       << row.pivots << " "
+       << std::setprecision(1) << std::fixed << row.peakrss << " "
+       << std::setprecision(4) << std::fixed << row.baseruntime << " "
+       << row.flag << std::endl;
+}
+
+/// the objective reached by most optimal runs is the reference, the other optimal runs are mismatches
+static void check_objectives(std::vector<regress_row>& rows, std::size_t beg, std::size_t end)
+{
+    std::size_t ref = end;
+    std::size_t ref_cnt = 0;
+    for(std::size_t r = beg; r < end; r++)
+    {
+        if(rows[r].optstatus != "Optimal")
+            continue;
+        std::size_t cnt = 0;
+        for(std::size_t s = beg; s < end; s++)
+            if(rows[s].optstatus == "Optimal"
+               && std::abs(rows[s].objvalue - rows[r].objvalue) <= REGRESSOBJTOL * std::max(1.0, std::abs(rows[r].objvalue)))
+                ++cnt;
+        if(cnt > ref_cnt)
+            ref_cnt = cnt, ref = r;
+    }
+
+    for(std::size_t r = beg; r < end; r++)
+    {
+        if(rows[r].optstatus != "Optimal")
+            rows[r].flag = "failed";
+        else if(std::abs(rows[r].objvalue - rows[ref].objvalue) > REGRESSOBJTOL * std::max(1.0, std::abs(rows[ref].objvalue)))
+            rows[r].flag = "mismatch";
+    }
+}
+
+unsigned long run_regression(const std::vector<std::string>& cfg_fnames, std::string resfname, std::string basefname, double threshold)
+{
+    /// configurations, tagged with the file base name
+    std::vector<optcfg> cfgs;
+    std::vector<std::string> cfg_tags;
+    for(auto it = cfg_fnames.begin(); it != cfg_fnames.end(); it++)
+    {
+        std::string tag = it->substr(it->find_last_of("/") + 1, it->size());
+        tag = tag.substr(0, tag.find_last_of("."));
+        cfgs.push_back(optcfg(*it));
+        cfg_tags.push_back(tag);
+    }
+    if(cfgs.empty())
+        throw std::invalid_argument("No configuration to run");
+
+    /// baseline runtimes by instance and configuration
+    std::map<std::string, double> baseline;
+    if(!basefname.empty())
+    {
+        std::vector<regress_row> brows = read_regress_table(basefname);
+        for(auto it = brows.begin(); it != brows.end(); it++)
+            baseline[it->ifname + " " + it->algorithm] = it->runtime;
+        FILE_LOG(logINFO) << "Baseline " << basefname << " ::: rows >> " << brows.size();
+    }
+
+    std::ofstream ofs(resfname);
+    std::ofstream optres_ofs(resfname + ".optres");
+    if(!ofs || !optres_ofs)
+        throw std::runtime_error("File creation fails");
+
+    std::vector<regress_row> rows;
+    std::vector<ladder_instance> ladder = regression_ladder();
+    for(auto lit = ladder.begin(); lit != ladder.end(); lit++)
+    {
+        std::shared_ptr<TpInstance::TProblemData> tpdata_sptr = generate_instance(*lit);
+        instance_features ftrs = compute_features(*tpdata_sptr);
+        std::size_t beg = rows.size();
+
+        for(std::size_t c = 0; c < cfgs.size(); c++)
+        {
+            optcfg optc = cfgs[c];
+            if(optc.opt_algo == optcfg::Algo::AUTO)
+                optc = auto_config(ftrs, optc);
+            /// shielding neighbourhoods are exact for squared Euclidean grid costs only
+            if(optc.opt_algo == optcfg::Algo::TS && optc.alg_mode / 1000 % 10 == 4 && !ftrs.sqeuclid_grid)
+            {
+                FILE_LOG(logINFO) << "Run " << lit->name << " " << cfg_tags[c] << " skipped ::: shielding needs squared Euclidean grid costs";
+                continue;
+            }
+
+            regress_row row;
+            row.ifname = lit->name;
+            row.algorithm = cfg_tags[c];
+
+            /// the result line of the run
+            auto job = [&]()
+            {
+                optresult optres = solve_run(tpdata_sptr, optc);
+                optres.tags.resize(optres.tags_cnt);
+                optres.tags[0] = lit->name;
+                optres.tags[1] = getAlg(optc.opt_algo) + "_" + std::to_string(optc.alg_mode);
+                std::ostringstream oss;
+                optres.write(oss);
+                return oss.str();
+            };
+
+            std::string line;
+            bool ok = false;
+            #ifndef _WIN32
+            ok = run_forked(job, line, row.peakrss);
+            #else
+            try
+            {
+                line = job();
+                ok = true;
+            }
+            catch(std::exception& e)
+            {
+                FILE_LOG(logERROR) << "Run failed, msg: " << e.what();
+            }
+            #endif
+            if(ok && !line.empty())
+            {
+                parse_optres_line(line, row);
+                optres_ofs << line;
+            }
+
+            auto bit = baseline.find(row.ifname + " " + row.algorithm);
+            if(bit != baseline.end())
+                row.baseruntime = bit->second;
+
+            rows.push_back(row);
+        }
+
+        /// all configurations must reach the same optimum, then runtimes against the baseline
+        check_objectives(rows, beg, rows.size());
+        for(std::size_t r = beg; r < rows.size(); r++)
+        {
+            regress_row& row = rows[r];
+            if(row.flag == "ok" && row.baseruntime >= REGRESSMINTIME && row.runtime > row.baseruntime * (1.0 + threshold))
+                row.flag = "regression";
+
+            write_regress_row(ofs, row);
+            TLogLevel lvl = row.flag == "ok" ? logINFO : logWARNING;
+            FILE_LOG(lvl)
+                << "Run " << row.ifname << " " << row.algorithm
+                << " ::: status >> " << row.optstatus
+                << " ::: Obj F >> " << std::setprecision(4) << std::fixed << row.objvalue
+                << " ::: time >> " << row.runtime << " [s]"
+                << " ::: baseline >> " << row.baseruntime << " [s]"
+                << " ::: pivots >> " << row.pivots
+                << " ::: peak RSS >> " << std::setprecision(1) << row.peakrss << " [MB]"
+                << " ::: " << row.flag;
+        }
+        ofs.flush();
+        optres_ofs.flush();
+    }
+
+    unsigned long flagged = 0;
+    for(auto it = rows.begin(); it != rows.end(); it++)
+        if(it->flag != "ok")
+            ++flagged;
+    FILE_LOG(logINFO) << "Regression done ::: runs >> " << rows.size() << " ::: flagged >> " << flagged;
+
+    return flagged;
+}
@@ -0,0 +1,82 @@
+///
+/// src/utility/optregress.h
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#ifndef OPTREGRESS_H
+#define OPTREGRESS_H
+
+#include <string>
+#include <vector>
+#include <limits>
+
+#include "TpInstance.h"
+
+/// an instance of the regression ladder, generated with a fixed seed by TpInstance::generateData(..)
+/// or, for a family, by TpGenerator
+struct ladder_instance
+{
+    std::string name;
+    bool ap = false;
+    /// squared Euclidean costs of a sqrt(m) x sqrt(m) grid, see TProblemData::setGridCosts()
+    bool grid = false;
+    /// family of TpGenerator::setFamily(..), empty for TpInstance::generateData(..)
+    std::string family;
+    NodeArcIdType m = 0;
+    NodeArcIdType n = 0;
+    unsigned int minq = 1;
+    unsigned int maxq = 100;
+    double minc = 1.0;
+    double maxc = 1000.0;
+    unsigned long long seed = 1;
+    /// unbalanced family instance, see TpGenerator::params
+    double surplus = 0.0;
+};
+
+/// a line of the regression table, see table regresults of sql/result.sql
+struct regress_row
+{
+    std::string ifname;
+    std::string algorithm;
+    std::string optstatus = "Failed";
+    double objvalue = std::numeric_limits<double>::quiet_NaN();
+    /// [s]
+    double runtime = std::numeric_limits<double>::quiet_NaN();
+    long long pivots = 0;
+    /// [MB], nan if not measured
+    double peakrss = std::numeric_limits<double>::quiet_NaN();
+    /// runtime of the baseline, nan if none
+    double baseruntime = std::numeric_limits<double>::quiet_NaN();
+    /// ok, mismatch (objective differs from the other configurations), regression, failed
+    std::string flag = "ok";
+};
+
+/// function prototypes
+
+/// the built-in ladder: TP, AP and grid instances of increasing size, then the structured families
+std::vector<ladder_instance> regression_ladder();
+
+/// rows of a regression table file
+std::vector<regress_row> read_regress_table(std::string fname);
+
+/// solve every ladder instance with every configuration, one process per run when available (peak RSS),
+/// check that all the configurations reach the same objective and compare the runtimes with the
+/// baseline table, if any (empty name): rows slower by more than the threshold are flagged
+/// the rows go to the results table, the complete optimization results to results.optres
+/// returns the number of flagged rows
+unsigned long run_regression(const std::vector<std::string>& cfg_fnames, std::string results_fname,
+                             std::string baseline_fname = "", double threshold = 0.25);
+
+
+#endif // OPTREGRESS_H
@@ -34,28 +34,33 @@ void optresult::write(std::string fname)
     if(!ofs.is_open())
         throw std::runtime_error("File not found");
     
+    this->write(ofs);
+    
+    ofs.close();
+}
+
+void optresult::write(std::ostream& os)
+{
     /// strings
     for(auto it = tags.begin(); it != tags.end(); it++)
-        ofs << (*it) << " ";
+        os << (*it) << " ";
     
     /// doubles
-    ofs << std::setprecision(4) << std::fixed << root_lprlx << " ";
-    ofs << std::setprecision(4) << std::fixed << root_time << " ";
-    ofs << std::setprecision(4) << std::fixed << best_bound << " ";
-    ofs << std::setprecision(4) << std::fixed << obj_value << " ";
-    ofs << std::setprecision(4) << std::fixed << opt_gap << " ";
-    ofs << std::setprecision(4) << std::fixed << run_time << " ";
+    os << std::setprecision(4) << std::fixed << root_lprlx << " ";
+    os << std::setprecision(4) << std::fixed << root_time << " ";
+    os << std::setprecision(4) << std::fixed << best_bound << " ";
+    os << std::setprecision(4) << std::fixed << obj_value << " ";
+    os << std::setprecision(4) << std::fixed << opt_gap << " ";
+    os << std::setprecision(4) << std::fixed << run_time << " ";
     /// integers
     for(auto it = integer_values.begin(); it != integer_values.end(); it++)
-        ofs << (*it) << " ";
+        os << (*it) << " ";
     
     /// doubles
     for(auto it = double_values.begin(); it != double_values.end(); it++)
-        ofs << (*it) << (std::next(it) != double_values.end() ? " " : "");
+        os << (*it) << (std::next(it) != double_values.end() ? " " : "");
     
-    ofs << std::endl;
-    
-    ofs.close();
+    os << std::endl;
 }
 
 /// function implementation
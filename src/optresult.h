@@ -20,6 +20,7 @@
 #include <string>
 #include <limits>
 #include <vector>
+#include <ostream>
 
 
 struct optresult
@@ -41,6 +42,7 @@ struct optresult
     std::vector<double> double_values;
     
     void write(std::string);
+    void write(std::ostream&);
 };
 
 /// function prototype
@@ -0,0 +1,567 @@
+///
+/// tools/iiobench.cpp
+///
+/// Micro-benchmarks of the simplex kernels on generated instances
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#include "TSimplex.h"
+#include "TpGenerator.h"
+#include "log.h"
+
+/// [s] timed per repetition, repetitions per benchmark
+#define BENCHMINTIME 0.2
+#define BENCHREPS 5
+/// entering cells cycled by the loop benchmarks
+#define BENCHCELLS 1024
+
+
+///
+/// Timing state of a benchmark run, the kernel runs while(st.keepRunning()),
+/// code between pauseTiming() and resumeTiming() is not timed
+///
+class BenchState
+{
+public:
+    explicit BenchState(unsigned long long iters) : max_iters(iters) { }
+
+    inline bool keepRunning()
+    {
+        if(done == 0 && !running)
+        {
+            running = true;
+            start = std::chrono::steady_clock::now();
+        }
+        if(done < max_iters)
+        {
+            ++done;
+            return true;
+        }
+        elapsed += std::chrono::steady_clock::now() - start;
+        running = false;
+        return false;
+    }
+    inline void pauseTiming()
+    {
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+    inline void resumeTiming()
+    {
+        start = std::chrono::steady_clock::now();
+    }
+
+    unsigned long long iterations() const { return max_iters; }
+    double seconds() const { return std::chrono::duration<double>(elapsed).count(); }
+
+private:
+    unsigned long long max_iters;
+    unsigned long long done = 0;
+    bool running = false;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::duration::zero();
+};
+
+///
+/// Solver state at the MMR basis of an instance: the kernels run on the buffers of tsimplex(..)
+///
+class TSimplexBench
+{
+public:
+    TSimplexBench(const std::shared_ptr<TpInstance::TProblemData>& data, unsigned long long mode)
+        : tpdata_sptr(data), tspx(data, mode, 10, 1, 10.0)
+        , rndgen(data->rndseed)
+    {
+        M = data->m;
+        N = data->n;
+        this->reset();
+    }
+
+    /// MMR basis, its tree and multipliers
+    void reset()
+    {
+        algd_sptr.reset(new tplex_alg_data(tpdata_sptr, true));
+        tspx.initVarData(algd_sptr->vdata);
+        tspx.initRowMinCosts(algd_sptr->vdata);
+        tspx.initRowSortedCosts(algd_sptr->vdata);
+        tspx.matrix_min_rule(algd_sptr);
+        spat_sptr.reset(new SpanningTree(M + N - 1, M + N, M));
+        spat_sptr->compute(algd_sptr->rows, algd_sptr->cols);
+        algd_sptr->vdata.spat_sptr = spat_sptr;
+        spat_sptr->computeTSpxMultips(tpdata_sptr->costs, algd_sptr->us, algd_sptr->vs);
+    }
+
+    bool isBasic(NodeArcIdType i, NodeArcIdType j)
+    {
+        return spat_sptr->getPredecessor(i) == SpanningTree::NodeType(M + j)
+               || spat_sptr->getPredecessor(M + j) == SpanningTree::NodeType(i);
+    }
+
+    /// random non-basic cell
+    CellVar randomCell()
+    {
+        std::uniform_int_distribution<NodeArcIdType> rndi(0, M - 1);
+        std::uniform_int_distribution<NodeArcIdType> rndj(0, N - 1);
+        NodeArcIdType i;
+        NodeArcIdType j;
+        do
+        {
+            i = rndi(rndgen);
+            j = rndj(rndgen);
+        }
+        while(this->isBasic(i, j));
+        return CellVar(i, j, tpdata_sptr->costs[N * i + j]);
+    }
+
+    /// basis change entering a random cell: not an improving pivot, but the basis stays primal feasible
+    void pivot(BenchState* st_time_move, BenchState* st_time_update)
+    {
+        CellVar ev = this->randomCell();
+        Loop loop(N);
+        spat_sptr->findLoop(ev, loop);
+        double min_q = loop.getMinQ(algd_sptr->quantities).first;
+
+        exited.clear();
+        unzeroed.clear();
+        if(st_time_move) st_time_move->resumeTiming();
+        loop.moveQuantity(min_q, tpdata_sptr->costs, algd_sptr->quantities, exited, unzeroed, nullptr, nullptr, true);
+        if(st_time_move) st_time_move->pauseTiming();
+
+        if(st_time_update) st_time_update->resumeTiming();
+        spat_sptr->update(std::make_pair(exited[0].i, M + exited[0].j), std::make_pair(ev.i, M + ev.j));
+        if(st_time_update) st_time_update->pauseTiming();
+    }
+
+    /// private kernels of TSimplex
+    void pricing(unsigned int rccpol)
+    {
+        varredcsts.clear();
+        entering_vars.clear();
+        switch(rccpol)
+        {
+            case 0:
+                tspx.computeReducedCostsPol_0(algd_sptr->quantities, algd_sptr->us, algd_sptr->vs, algd_sptr->vdata, varredcsts, entering_vars);
+                break;
+            case 1:
+                tspx.computeReducedCostsPol_1(algd_sptr->quantities, algd_sptr->us, algd_sptr->vs, algd_sptr->vdata, varredcsts, entering_vars);
+                break;
+            case 3:
+                tspx.computeReducedCostsPol_3(algd_sptr->quantities, algd_sptr->us, algd_sptr->vs, algd_sptr->vdata, varredcsts, entering_vars);
+                break;
+            case 5:
+                tspx.computeReducedCostsPol_5(algd_sptr->quantities, algd_sptr->us, algd_sptr->vs, algd_sptr->vdata, varredcsts, entering_vars);
+                break;
+            default:
+                throw std::invalid_argument("Unknown r.c. computation method");
+        }
+    }
+    void initVarData(tplex_alg_data::var_data& vdata)
+    {
+        tspx.initVarData(vdata);
+    }
+    void shields(NodeArcIdType side, Shielding::THEgrid& board, std::vector<std::vector<NodeArcIdType>>& supp)
+    {
+        varredcsts.clear();
+        tspx.compute_shields_v2(tpdata_sptr->costs, false, M, N, side, board, supp, varredcsts, EPSQ);
+    }
+
+    std::shared_ptr<TpInstance::TProblemData> tpdata_sptr;
+    TSimplex tspx;
+    std::shared_ptr<tplex_alg_data> algd_sptr;
+    std::shared_ptr<SpanningTree> spat_sptr;
+    std::vector<CellVar> varredcsts;
+    std::vector<CellVar> entering_vars;
+    std::vector<CellVar> exited;
+    std::vector<CellVar> unzeroed;
+    std::default_random_engine rndgen;
+    NodeArcIdType M;
+    NodeArcIdType N;
+};
+
+/// instance of the sweep
+struct bench_instance
+{
+    NodeArcIdType m;
+    NodeArcIdType n;
+    double minc;
+    double maxc;
+    bool ap;
+    /// squared Euclidean costs of a sqrt(m) x sqrt(m) grid instead of random costs
+    bool grid;
+    /// family of TpGenerator::setFamily(..), empty for TpInstance::generateData(..)
+    std::string family;
+};
+
+/// benchmark of a kernel on the fixture of the given alg. mode
+struct bench_case
+{
+    std::string name;
+    unsigned long long mode;
+    /// runs on grid instances only
+    bool grid_only;
+    std::function<void(TSimplexBench&, BenchState&)> run;
+};
+
+static void benchPricing(TSimplexBench& fx, BenchState& st, unsigned int rccpol)
+{
+    while(st.keepRunning())
+        fx.pricing(rccpol);
+}
+
+static std::vector<bench_case> benchCases()
+{
+    std::vector<bench_case> cases;
+
+    cases.push_back({"multipliers", 23111, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        while(st.keepRunning())
+            fx.spat_sptr->computeTSpxMultips(fx.tpdata_sptr->costs, fx.algd_sptr->us, fx.algd_sptr->vs);
+    }});
+    cases.push_back({"pricing_pol0", 20000, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        benchPricing(fx, st, 0);
+    }});
+    cases.push_back({"pricing_pol1", 21000, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        benchPricing(fx, st, 1);
+    }});
+    cases.push_back({"pricing_pol3", 23111, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        benchPricing(fx, st, 3);
+    }});
+    cases.push_back({"pricing_pol5", 25001, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        benchPricing(fx, st, 5);
+    }});
+    cases.push_back({"find_loop", 23111, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        std::vector<CellVar> cells;
+        for(unsigned int k = 0; k < BENCHCELLS; k++)
+            cells.push_back(fx.randomCell());
+        Loop loop(fx.N);
+        std::size_t k = 0;
+        while(st.keepRunning())
+        {
+            loop.clear();
+            fx.spat_sptr->findLoop(cells[k++ % cells.size()], loop);
+        }
+    }});
+    cases.push_back({"loop_min_q", 23111, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        std::vector<Loop> loops(BENCHCELLS, Loop(fx.N));
+        for(auto it = loops.begin(); it != loops.end(); it++)
+            fx.spat_sptr->findLoop(fx.randomCell(), *it);
+        std::size_t k = 0;
+        while(st.keepRunning())
+            loops[k++ % loops.size()].getMinQ(fx.algd_sptr->quantities);
+    }});
+    cases.push_back({"move_quantity", 23111, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        while(st.keepRunning())
+        {
+            st.pauseTiming();
+            fx.pivot(&st, nullptr);
+            st.resumeTiming();
+        }
+    }});
+    cases.push_back({"tree_update", 23111, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        while(st.keepRunning())
+        {
+            st.pauseTiming();
+            fx.pivot(nullptr, &st);
+            st.resumeTiming();
+        }
+    }});
+    cases.push_back({"init_var_data", 23111, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        tplex_alg_data::var_data vdata;
+        while(st.keepRunning())
+        {
+            st.pauseTiming();
+            vdata = tplex_alg_data::var_data();
+            st.resumeTiming();
+            fx.initVarData(vdata);
+        }
+    }});
+    cases.push_back({"matrix_min_rule", 23111, false, [](TSimplexBench& fx, BenchState& st)
+    {
+        std::shared_ptr<tplex_alg_data> algd_sptr(new tplex_alg_data(fx.tpdata_sptr, true));
+        fx.initVarData(algd_sptr->vdata);
+        while(st.keepRunning())
+        {
+            st.pauseTiming();
+            algd_sptr->clearSol();
+            algd_sptr->partial_basis_size = 0;
+            st.resumeTiming();
+            fx.tspx.matrix_min_rule(algd_sptr);
+        }
+    }});
+    cases.push_back({"shields", 24000, true, [](TSimplexBench& fx, BenchState& st)
+    {
+        NodeArcIdType side = std::sqrt(fx.M);
+        Shielding::THEgrid board;
+        std::vector<std::vector<NodeArcIdType>> supp;
+        Shielding::THEgenerateSquareGrid(board, fx.M, side);
+        fx.spat_sptr->computeTSpxShieldingSupp(fx.algd_sptr->quantities, supp, EPSQ);
+        while(st.keepRunning())
+        {
+            fx.shields(side, board, supp);
+        }
+    }});
+
+    return cases;
+}
+
+static std::shared_ptr<TpInstance::TProblemData> makeInstance(const bench_instance& bi, unsigned long long seed)
+{
+    std::shared_ptr<TpInstance::TProblemData> data;
+    if(bi.family.empty())
+    {
+        data = TpInstance::generateData(bi.ap, 1, 100, bi.minc, bi.maxc, bi.m, bi.n, seed);
+        if(bi.grid)
+            data->setGridCosts();
+    }
+    else
+    {
+        TpGenerator::params prms;
+        prms.ap = bi.ap;
+        prms.minc = bi.minc;
+        prms.maxc = bi.maxc;
+        prms.m = bi.m;
+        prms.n = bi.n;
+        prms.seed = seed;
+        TpGenerator::setFamily(bi.family, prms);
+        data = TpGenerator(prms).generate();
+    }
+    data->computeQuantityStats();
+    return data;
+}
+
+static std::string instanceTag(const bench_instance& bi)
+{
+    std::stringstream ss;
+    ss << (bi.ap ? "ap" : "tp") << "/" << bi.m << "x" << bi.n << "/";
+    if(!bi.family.empty())
+    {
+        ss << bi.family;
+        if(bi.maxc > 0.0)
+            ss << "/" << bi.minc << "-" << bi.maxc;
+    }
+    else if(bi.grid)
+        ss << "grid";
+    else
+        ss << bi.minc << "-" << bi.maxc;
+    return ss.str();
+}
+
+/// iterations reaching the min. time, then timed repetitions; returns min. and median ns per iteration
+static std::tuple<unsigned long long, double, double> runCase(const bench_case& bc, TSimplexBench& fx, double min_time, unsigned int reps)
+{
+    unsigned long long iters = 1;
+    while(true)
+    {
+        BenchState st(iters);
+        bc.run(fx, st);
+        if(st.seconds() >= min_time || iters >= (1ULL << 40))
+            break;
+        /// Google Benchmark style growth: aim at 1.4x the min. time, at most 10x per round
+        double mult = st.seconds() > 0.0 ? 1.4 * min_time / st.seconds() : 10.0;
+        iters = std::max(iters + 1, (unsigned long long)(iters * std::min(10.0, mult)));
+    }
+
+    std::vector<double> ns;
+    for(unsigned int r = 0; r < reps; r++)
+    {
+        BenchState st(iters);
+        bc.run(fx, st);
+        ns.push_back(st.seconds() * 1.0e9 / iters);
+    }
+    std::sort(ns.begin(), ns.end());
+    return std::make_tuple(iters, ns.front(), ns[ns.size() / 2]);
+}
+
+/// "a,b,c" -> {a, b, c}
+static std::vector<std::string> splitList(const std::string& s)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(s);
+    std::string item;
+    while(std::getline(ss, item, ','))
+        if(!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+static void usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [options]" << std::endl
+              << "\t--filter=s        benchmarks whose name contains s" << std::endl
+              << "\t--sizes=MxN,...   instance sizes (default 100x100,300x300,1000x1000,200x800)" << std::endl
+              << "\t--costs=a-b,...   random cost ranges (default 1-100,1-10000)" << std::endl
+              << "\t--grids=K,...     K x K grids of the shielding benchmark (default 10,20,30)" << std::endl
+              << "\t--families=f,...  tpgen families of the sizes besides the random costs: euclid, sqeuclid," << std::endl
+              << "\t                  clustered, forbidden, sparse (cost ranges apply) or grid (K x K sizes, shielding too)" << std::endl
+              << "\t--ap              assignment instances (m = n only)" << std::endl
+              << "\t--min-time=s      timed seconds per repetition (default " << BENCHMINTIME << ")" << std::endl
+              << "\t--reps=r          repetitions (default " << BENCHREPS << ")" << std::endl
+              << "\t--seed=s          instance seed (default 1)" << std::endl
+              << "\t--csv             CSV output" << std::endl;
+}
+
+
+int main(int argc, char **argv)
+{
+    std::string filter;
+    std::vector<std::string> sizes = {"100x100", "300x300", "1000x1000", "200x800"};
+    std::vector<std::string> costs = {"1-100", "1-10000"};
+    std::vector<std::string> grids = {"10", "20", "30"};
+    std::vector<std::string> families;
+    bool ap = false;
+    bool csv = false;
+    double min_time = BENCHMINTIME;
+    unsigned int reps = BENCHREPS;
+    unsigned long long seed = 1;
+
+    /// solver logs are not of interest here
+    FILELog::ReportingLevel() = logERROR;
+
+    try
+    {
+        for(int a = 1; a < argc; a++)
+        {
+            std::string arg(argv[a]);
+            std::string val = arg.find('=') != std::string::npos ? arg.substr(arg.find('=') + 1) : "";
+            if(arg.rfind("--filter=", 0) == 0)
+                filter = val;
+            else if(arg.rfind("--sizes=", 0) == 0)
+                sizes = splitList(val);
+            else if(arg.rfind("--costs=", 0) == 0)
+                costs = splitList(val);
+            else if(arg.rfind("--grids=", 0) == 0)
+                grids = splitList(val);
+            else if(arg.rfind("--families=", 0) == 0)
+                families = splitList(val);
+            else if(arg == "--ap")
+                ap = true;
+            else if(arg == "--csv")
+                csv = true;
+            else if(arg.rfind("--min-time=", 0) == 0)
+                min_time = std::stod(val);
+            else if(arg.rfind("--reps=", 0) == 0)
+                reps = std::max(1, std::stoi(val));
+            else if(arg.rfind("--seed=", 0) == 0)
+                seed = std::stoull(val);
+            else
+            {
+                usage(argv[0]);
+                return arg == "--help" || arg == "-h" ? 0 : -1;
+            }
+        }
+
+        /// instance sweep: sizes x cost ranges, then the grids
+        std::vector<bench_instance> insts;
+        for(auto sit = sizes.begin(); sit != sizes.end(); sit++)
+        {
+            std::size_t x = sit->find('x');
+            if(x == std::string::npos)
+                throw std::invalid_argument("Bad size '" + *sit + "', expected MxN");
+            NodeArcIdType m = std::stoul(sit->substr(0, x));
+            NodeArcIdType n = std::stoul(sit->substr(x + 1));
+            if(ap && m != n)
+                continue;
+            for(auto cit = costs.begin(); cit != costs.end(); cit++)
+            {
+                std::size_t d = cit->find('-');
+                if(d == std::string::npos)
+                    throw std::invalid_argument("Bad cost range '" + *cit + "', expected a-b");
+                insts.push_back({m, n, std::stod(cit->substr(0, d)), std::stod(cit->substr(d + 1)), ap, false, ""});
+            }
+            /// geometric families do not depend on the cost range
+            for(auto fit = families.begin(); fit != families.end(); fit++)
+            {
+                TpGenerator::params prms;
+                TpGenerator::setFamily(*fit, prms);
+                NodeArcIdType g = std::llround(std::sqrt(m));
+                if(prms.points == TpGenerator::Points::Grid && (m != n || g * g != m))
+                    continue;
+                if(prms.costs != TpGenerator::Costs::Uniform)
+                    insts.push_back({m, n, 0.0, 0.0, ap, prms.points == TpGenerator::Points::Grid, *fit});
+                else
+                    for(auto cit = costs.begin(); cit != costs.end(); cit++)
+                    {
+                        std::size_t d = cit->find('-');
+                        insts.push_back({m, n, std::stod(cit->substr(0, d)), std::stod(cit->substr(d + 1)), ap, false, *fit});
+                    }
+            }
+        }
+        for(auto git = grids.begin(); git != grids.end(); git++)
+        {
+            NodeArcIdType k = std::stoul(*git);
+            insts.push_back({k * k, k * k, 0.0, 0.0, ap, true, ""});
+        }
+
+        std::vector<bench_case> cases = benchCases();
+        if(csv)
+            std::cout << "benchmark,instance,m,n,iterations,min_ns,median_ns" << std::endl;
+        else
+            std::cout << std::left << std::setw(44) << "Benchmark" << std::right
+                      << std::setw(14) << "Iterations" << std::setw(16) << "Min [ns]" << std::setw(16) << "Median [ns]" << std::endl
+                      << std::string(90, '-') << std::endl;
+
+        for(auto iit = insts.begin(); iit != insts.end(); iit++)
+        {
+            std::shared_ptr<TpInstance::TProblemData> data;
+            for(auto cit = cases.begin(); cit != cases.end(); cit++)
+            {
+                if(cit->grid_only != iit->grid || (!filter.empty() && cit->name.find(filter) == std::string::npos))
+                    continue;
+                if(data == nullptr)
+                    data = makeInstance(*iit, seed);
+
+                /// fresh fixture per benchmark, pivots of a benchmark change the basis
+                TSimplexBench fx(data, cit->mode);
+                auto res = runCase(*cit, fx, min_time, reps);
+                std::string tag = instanceTag(*iit);
+                if(csv)
+                    std::cout << cit->name << ',' << tag << ',' << iit->m << ',' << iit->n << ','
+                              << std::get<0>(res) << ',' << std::fixed << std::setprecision(1)
+                              << std::get<1>(res) << ',' << std::get<2>(res) << std::endl;
+                else
+                    std::cout << std::left << std::setw(44) << (cit->name + "/" + tag) << std::right
+                              << std::setw(14) << std::get<0>(res) << std::fixed << std::setprecision(1)
+                              << std::setw(16) << std::get<1>(res) << std::setw(16) << std::get<2>(res) << std::endl;
+            }
+        }
+    }
+    catch(std::exception& e)
+    {
+        std::cout << "Program thrown an exception, msg: " << e.what() << std::endl << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
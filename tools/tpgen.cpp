@@ -0,0 +1,144 @@
+///
+/// tools/tpgen.cpp
+///
+/// Generates a random instance file, text or binary, with TpGenerator
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <iostream>
+#include <string>
+
+#include "TpGenerator.h"
+#include "log.h"
+
+
+/// "a-b" -> a, b
+static void parse_range(const std::string& s, double& lo, double& hi)
+{
+    std::size_t d = s.find('-');
+    if(d == std::string::npos)
+        throw std::invalid_argument("Bad range '" + s + "', expected a-b");
+    lo = std::stod(s.substr(0, d));
+    hi = std::stod(s.substr(d + 1));
+}
+
+static void usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " m n seed file [options]" << std::endl
+              << "\t--ap              assignment problem (m = n, unit quantities)" << std::endl
+              << "\t--q=a-b           supply and demand range (default 1-100)" << std::endl
+              << "\t--c=a-b           integer cost range (default 1-1000)" << std::endl
+              << "\t--family=f        uniform (default), euclid, sqeuclid, grid, clustered, forbidden, sparse or capacitated" << std::endl
+              << "\t--clusters=k      supply sites of the clustered family (default 8)" << std::endl
+              << "\t--side=L          points in [0, L) x [0, L) (default 1000)" << std::endl
+              << "\t--forbidden=f     fraction of forbidden lanes (default 0, 0.2 for the forbidden family, 0.9 for the sparse one)" << std::endl
+              << "\t--sparse          sparse text file of the allowed lanes only" << std::endl
+              << "\t--surplus=f       unbalanced, supply exceeds (f > 0) or falls short of (f < 0) demand by f x demand" << std::endl
+              << "\t--capacitated=f   fraction of capacitated lanes (default 0, 0.3 for the capacitated family), text files only" << std::endl
+              << "\t--threads=k       generator threads (default, all the hardware threads)" << std::endl
+              << "\t--bin             binary file, see TpInstance.h" << std::endl;
+}
+
+
+int main(int argc, char **argv)
+{
+    if(argc < 5)
+    {
+        usage(argv[0]);
+        return -1;
+    }
+
+    try
+    {
+        TpGenerator::params prms;
+        unsigned int threads = 0;
+        bool binary = false;
+        std::string family = "uniform";
+        unsigned int clusters = 0;
+        unsigned int side = 0;
+        double forbidden = -1.0;
+        bool sparse = false;
+        double surplus = 0.0;
+        double capacitated = -1.0;
+        prms.m = std::stoul(argv[1]);
+        prms.n = std::stoul(argv[2]);
+        prms.seed = std::stoull(argv[3]);
+        std::string fname(argv[4]);
+
+        for(int a = 5; a < argc; a++)
+        {
+            std::string arg(argv[a]);
+            std::string val = arg.find('=') != std::string::npos ? arg.substr(arg.find('=') + 1) : "";
+            double lo;
+            double hi;
+            if(arg == "--ap")
+                prms.ap = true;
+            else if(arg == "--bin")
+                binary = true;
+            else if(arg == "--sparse")
+                sparse = true;
+            else if(arg.rfind("--q=", 0) == 0)
+            {
+                parse_range(val, lo, hi);
+                prms.minq = lo;
+                prms.maxq = hi;
+            }
+            else if(arg.rfind("--c=", 0) == 0)
+                parse_range(val, prms.minc, prms.maxc);
+            else if(arg.rfind("--threads=", 0) == 0)
+                threads = std::stoul(val);
+            else if(arg.rfind("--family=", 0) == 0)
+                family = val;
+            else if(arg.rfind("--clusters=", 0) == 0)
+                clusters = std::stoul(val);
+            else if(arg.rfind("--side=", 0) == 0)
+                side = std::stoul(val);
+            else if(arg.rfind("--forbidden=", 0) == 0)
+                forbidden = std::stod(val);
+            else if(arg.rfind("--surplus=", 0) == 0)
+                surplus = std::stod(val);
+            else if(arg.rfind("--capacitated=", 0) == 0)
+                capacitated = std::stod(val);
+            else
+            {
+                usage(argv[0]);
+                return -1;
+            }
+        }
+        /// the family first, then the explicit settings
+        TpGenerator::setFamily(family, prms);
+        if(clusters > 0)
+            prms.clusters = clusters;
+        if(side > 0)
+            prms.side = side;
+        if(forbidden >= 0.0)
+            prms.forbidden = forbidden;
+        prms.sparse = prms.sparse || sparse;
+        prms.surplus = surplus;
+        if(capacitated >= 0.0)
+            prms.capacitated = capacitated;
+
+        /// progress on the standard error
+        FILELog::ReportingLevel() = logINFO;
+        TpGenerator gen(prms, threads);
+        gen.write(fname, binary);
+    }
+    catch(std::exception& e)
+    {
+        std::cout << "Program thrown an exception, msg: " << e.what() << std::endl << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
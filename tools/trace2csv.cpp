@@ -0,0 +1,56 @@
+///
+/// tools/trace2csv.cpp
+///
+/// Converts a binary iteration trace of the simplex (cfg key trace=1) to CSV
+///
+/// Written by Roberto Bargetto
+/// 	   DIGEP
+/// 	   Politecnico di Torino
+/// 	   Corso Duca degli Abruzzi, 10129, Torino
+/// 	   Italy
+///
+/// Copyright 2024 by Roberto Bargetto
+/// roberto.bargetto@polito.it or roberto.bargetto@gmail.com
+///
+/// This work is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License (CC BY-NC-SA 4.0)
+/// See the license at http://creativecommons.org/licenses/by-nc-sa/4.0/
+///
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "itertrace.h"
+
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " trace [csv]" << std::endl;
+        return -1;
+    }
+
+    try
+    {
+        std::vector<iter_record> recs = read_trace(argv[1]);
+
+        /// to standard output if no CSV file is given
+        if(argc > 2)
+        {
+            std::ofstream ofs(argv[2]);
+            if(!ofs)
+                throw std::runtime_error("File creation fails");
+            write_trace_csv(recs, ofs);
+        }
+        else
+            write_trace_csv(recs, std::cout);
+    }
+    catch(std::exception& e)
+    {
+        std::cout << "Program thrown an exception, msg: " << e.what() << std::endl << std::endl;
+        return -1;
+    }
+
+    return 0;
+}